@@ -2,6 +2,8 @@
 #define NOMINMAX
 #include <windows.h>	// delay, keyboard input
 #include "NxPhysics.h"	// PhysX SDK
+#include "Extras/Telemetry.h"	// asynchronous telemetry output
+#include "Extras/TraceEvents.h"	// timeline of the loop phases
 
 //function declarations
 bool InitPhysX();
@@ -25,6 +27,15 @@ NxActor* box = 0;
 
 float counter = 0.0f;
 
+//telemetry of all actors, written by a background thread
+TelemetryWriter telemetry;
+const char* telemetry_file = "telemetry.bin";	//use TELEMETRY_CSV in Start for a text file
+NxU32 step = 0;
+
+//timeline of the main loop, open the file in chrome://tracing
+TraceLog trace;
+const char* trace_file = "trace.json";
+
 int main()
 {
 	//initialise PhysX
@@ -38,24 +49,61 @@ int main()
 	//populate the scene with actors
 	InitScene();
 
+	//start the telemetry output
+	if (!telemetry.Start(telemetry_file, TELEMETRY_BINARY))
+		printf("Could not open %s, no telemetry will be written.\n", telemetry_file);
+
+	//start the trace
+	if (!trace.Start(trace_file))
+		printf("Could not open %s, no trace will be written.\n", trace_file);
+	trace.SetThreadName("main");
+
 	//MAIN LOOP
 	//loop until the 'Esc' key is pressed
 	while (!GetAsyncKeyState(VK_ESCAPE))
 	{
+		TraceScope loop(trace, "loop");
+
 		//perform one step of the simulation
-		SimulationStep();
+		{
+			TraceScope phase(trace, "simulate");
+			SimulationStep();
+		}
 
 		//while calculating render the results (from the previous step)
-		Display();
+		{
+			TraceScope phase(trace, "display");
+			Display();
+		}
 
 		//a short pause, just to slow down the display output, adjust according to your preferences
-		Sleep(200);
+		{
+			TraceScope phase(trace, "sleep");
+			Sleep(200);
+		}
 
 		//update the simulation results
-		GetPhysicsResults();
+		{
+			TraceScope phase(trace, "fetch");
+			GetPhysicsResults();
+		}
 
 		//custom processing procedure - apply forces, react to collisions etc.
-		UpdateScene();
+		{
+			TraceScope phase(trace, "update");
+			UpdateScene();
+		}
+	}
+
+	//flush the telemetry
+	telemetry.Stop();
+	printf("%u telemetry records written to %s, %u dropped\n", telemetry.GetNbWritten(), telemetry_file, telemetry.GetNbDropped());
+
+	//write the rest of the trace
+	if (trace.IsRecording())
+	{
+		trace.Stop();
+		printf("%u trace events written to %s, %u dropped\n", trace.GetNbWritten(), trace_file, trace.GetNbDropped());
 	}
 
 	//clean up memory
@@ -138,13 +186,14 @@ void UpdateScene()
 void Display()
 {
 	
-	//display object properties - global position and velocity
-	NxVec3 pos = box->getGlobalPosition();
-	NxVec3 vel = box->getLinearVelocity();
-
-	printf("pos %.2f %.2f %.2f :: ", pos.x, pos.y, pos.z);
-	printf("vel %.2f %.2f %.2f\n", vel.x, vel.y, vel.z);
-
+	//queue the global position and velocity of all actors, the formatting and writing is done by the telemetry thread
+	NxU32 nbActors = scene->getNbActors();
+	NxActor** actors = scene->getActors();
+	for (NxU32 i = 0; i < nbActors; i++)
+		telemetry.Push(step, i, *actors[i]);
+	step++;
+
+	//NxVec3 pos = box->getGlobalPosition();
 	////if loop on steps taken to generate cube
 	//if (pos.y >= 0.45)
 	//{
@@ -173,7 +222,8 @@ void Display()
 	//	box ->setGlobalPosition(NxVec3(10.0f, pos.y, pos.x));
 	//}
 
-	if (pos.x >= 1.00)
+	//stop the box once it has moved past x = 1
+	if (box->getGlobalPosition().x >= 1.00)
 	{
 
 		box->setLinearVelocity(NxVec3(0,0,0));
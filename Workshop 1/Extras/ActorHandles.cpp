@@ -0,0 +1,177 @@
+#include "NxPhysics.h"
+#include "ActorHandles.h"
+#include "UserData.h"
+
+ActorHandleTable::ActorHandleTable() : m_firstFree(INVALID_ACTOR_INDEX)
+{
+}
+
+ActorHandle ActorHandleTable::Add(NxActor& actor)
+{
+	ActorUserData* ud = (ActorUserData*)actor.userData;
+	if (!ud) return ActorHandle();
+	if (Get(ud->handle) == &actor) return ud->handle;
+
+	NxU32 index;
+	if (m_firstFree != INVALID_ACTOR_INDEX)
+	{
+		index = m_firstFree;
+		m_firstFree = m_slots[index].nextFree;
+	}
+	else
+	{
+		Slot slot;
+		slot.generation = 1;
+		index = m_slots.size();
+		m_slots.pushBack(slot);
+	}
+
+	Slot& slot = m_slots[index];
+	slot.actor = &actor;
+	slot.denseIndex = m_dense.size();
+	slot.selectableIndex = INVALID_ACTOR_INDEX;
+	slot.nextFree = INVALID_ACTOR_INDEX;
+	m_dense.pushBack(&actor);
+	m_denseSlots.pushBack(index);
+	if (IsSelectable(actor))
+		AddSelectable(index);
+
+	ud->handle = ActorHandle(index, slot.generation);
+	return ud->handle;
+}
+
+void ActorHandleTable::AddActors(NxScene& scene)
+{
+	NxU32 nbActors = scene.getNbActors();
+	NxActor** actors = scene.getActors();
+	for (NxU32 i = 0; i < nbActors; i++)
+		Add(*actors[i]);
+}
+
+void ActorHandleTable::Remove(ActorHandle handle)
+{
+	if (!IsCurrent(handle)) return;
+
+	Slot& slot = m_slots[handle.index];
+	ActorUserData* ud = (ActorUserData*)slot.actor->userData;
+	if (ud) ud->handle = ActorHandle();
+	RemoveSelectable(handle.index);
+
+	//move the last actor into the hole
+	NxU32 last = m_dense.size() - 1;
+	m_dense[slot.denseIndex] = m_dense[last];
+	m_denseSlots[slot.denseIndex] = m_denseSlots[last];
+	m_slots[m_denseSlots[last]].denseIndex = slot.denseIndex;
+	m_dense.popBack();
+	m_denseSlots.popBack();
+
+	FreeSlot(handle.index);
+}
+
+void ActorHandleTable::Clear()
+{
+	for (NxU32 i = 0; i < m_denseSlots.size(); i++)
+		FreeSlot(m_denseSlots[i]);
+	m_dense.clear();
+	m_denseSlots.clear();
+	m_selectable.clear();
+}
+
+void ActorHandleTable::FreeSlot(NxU32 index)
+{
+	Slot& slot = m_slots[index];
+	slot.actor = 0;
+	slot.denseIndex = INVALID_ACTOR_INDEX;
+	slot.selectableIndex = INVALID_ACTOR_INDEX;
+	if (!++slot.generation) slot.generation = 1;
+	slot.nextFree = m_firstFree;
+	m_firstFree = index;
+}
+
+bool ActorHandleTable::IsCurrent(ActorHandle handle) const
+{
+	return handle.IsValid() && handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation
+		&& m_slots[handle.index].actor;
+}
+
+NxActor* ActorHandleTable::Get(ActorHandle handle) const
+{
+	return IsCurrent(handle) ? m_slots[handle.index].actor : 0;
+}
+
+ActorHandle ActorHandleTable::GetHandle(const NxActor& actor) const
+{
+	ActorUserData* ud = (ActorUserData*)actor.userData;
+	if (!ud || Get(ud->handle) != &actor) return ActorHandle();
+	return ud->handle;
+}
+
+NxU32 ActorHandleTable::GetDenseIndex(ActorHandle handle) const
+{
+	return IsCurrent(handle) ? m_slots[handle.index].denseIndex : INVALID_ACTOR_INDEX;
+}
+
+ActorHandle ActorHandleTable::GetHandleAt(NxU32 denseIndex) const
+{
+	NxU32 index = m_denseSlots[denseIndex];
+	return ActorHandle(index, m_slots[index].generation);
+}
+
+bool ActorHandleTable::IsSelectable(const NxActor& actor)
+{
+	if (!actor.isDynamic()) return false;
+
+	//AddUserDataToShapes marks the actors that own a trigger shape
+	ActorUserData* ud = (ActorUserData*)actor.userData;
+	if (ud) return !(ud->flags & UD_IS_TRIGGER);
+
+	NxShape* const* shapes = actor.getShapes();
+	NxU32 nbShapes = actor.getNbShapes();
+	while (nbShapes--)
+		if (shapes[nbShapes]->getFlag(NX_TRIGGER_ENABLE))
+			return false;
+	return true;
+}
+
+void ActorHandleTable::UpdateSelectable(ActorHandle handle)
+{
+	if (!IsCurrent(handle)) return;
+
+	bool selectable = IsSelectable(*m_slots[handle.index].actor);
+	bool listed = m_slots[handle.index].selectableIndex != INVALID_ACTOR_INDEX;
+	if (selectable && !listed)
+		AddSelectable(handle.index);
+	else if (!selectable && listed)
+		RemoveSelectable(handle.index);
+}
+
+ActorHandle ActorHandleTable::GetNextSelectable(ActorHandle current) const
+{
+	if (!m_selectable.size()) return ActorHandle();
+
+	NxU32 next = 0;
+	if (IsCurrent(current) && m_slots[current.index].selectableIndex != INVALID_ACTOR_INDEX)
+		next = (m_slots[current.index].selectableIndex + 1) % m_selectable.size();
+
+	NxU32 index = m_selectable[next];
+	return ActorHandle(index, m_slots[index].generation);
+}
+
+void ActorHandleTable::AddSelectable(NxU32 index)
+{
+	m_slots[index].selectableIndex = m_selectable.size();
+	m_selectable.pushBack(index);
+}
+
+void ActorHandleTable::RemoveSelectable(NxU32 index)
+{
+	NxU32 selectableIndex = m_slots[index].selectableIndex;
+	if (selectableIndex == INVALID_ACTOR_INDEX) return;
+
+	//move the last selectable actor into the hole
+	NxU32 last = m_selectable[m_selectable.size() - 1];
+	m_selectable[selectableIndex] = last;
+	m_slots[last].selectableIndex = selectableIndex;
+	m_selectable.popBack();
+	m_slots[index].selectableIndex = INVALID_ACTOR_INDEX;
+}
@@ -0,0 +1,104 @@
+/// \file ActorHandles.h
+///
+/// \brief Stable, generation checked handles to actors.
+///
+
+#ifndef ACTORHANDLES_H
+#define ACTORHANDLES_H
+
+#include "NxPhysics.h"
+
+///
+/// Reference to an actor that can be kept across frames and scene resets.
+///
+/// The generation of a slot changes every time its actor is removed, so an old handle
+/// resolves to NULL instead of a dangling or reused pointer. Generation 0 is never used and
+/// marks the invalid handle.
+///
+struct ActorHandle
+{
+	NxU32 index;
+	NxU32 generation;
+
+	ActorHandle() : index(0), generation(0) {}
+	ActorHandle(NxU32 i, NxU32 g) : index(i), generation(g) {}
+
+	bool IsValid() const { return generation != 0; }
+	bool operator==(const ActorHandle& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const ActorHandle& other) const { return !(*this == other); }
+};
+
+static const NxU32 INVALID_ACTOR_INDEX = 0xffffffff;
+
+///
+/// Maps handles to actors and keeps the registered actors in a dense array.
+///
+/// Handle lookups and removals are O(1); the dense index of an actor changes when another actor
+/// is removed, so side data indexed by it has to be moved the same way (last into the hole).
+/// The handle of an actor is stored in its ActorUserData, which it must have to be registered.
+///
+/// The selectable actors (dynamic, without trigger shapes) are kept in a second dense array,
+/// maintained the same way on Add and Remove, so selection can be cycled in O(1).
+///
+class ActorHandleTable
+{
+public:
+	ActorHandleTable();
+
+	/// Register an actor, returns an invalid handle if it has no ActorUserData.
+	ActorHandle Add(NxActor& actor);
+
+	/// Register all actors of a scene that aren't registered yet.
+	void AddActors(NxScene& scene);
+
+	void Remove(ActorHandle handle);
+
+	/// Invalidate all handles, e.g. before the scene is released.
+	void Clear();
+
+	/// Actor of a handle, NULL if the handle is invalid or the actor was removed.
+	NxActor* Get(ActorHandle handle) const;
+	ActorHandle GetHandle(const NxActor& actor) const;
+
+	/// Position of the actor in GetActors(), INVALID_ACTOR_INDEX for a stale handle.
+	NxU32 GetDenseIndex(ActorHandle handle) const;
+
+	NxU32 GetNbActors() const { return m_dense.size(); }
+	NxActor* const* GetActors() const { return m_dense.size() ? &m_dense[0] : 0; }
+	ActorHandle GetHandleAt(NxU32 denseIndex) const;
+
+	/// Dynamic actors without trigger shapes can be selected. Uses UD_IS_TRIGGER of the user data, the
+	/// shape flags only for an actor without user data.
+	static bool IsSelectable(const NxActor& actor);
+
+	/// Re-evaluate IsSelectable after the body or shape flags of a registered actor changed.
+	void UpdateSelectable(ActorHandle handle);
+
+	NxU32 GetNbSelectable() const { return m_selectable.size(); }
+
+	/// Selectable actor after current, the first one if current isn't selectable; invalid if there is none.
+	ActorHandle GetNextSelectable(ActorHandle current) const;
+
+private:
+	struct Slot
+	{
+		NxActor* actor;
+		NxU32 generation;
+		NxU32 denseIndex;
+		NxU32 selectableIndex;
+		NxU32 nextFree;
+	};
+
+	bool IsCurrent(ActorHandle handle) const;
+	void FreeSlot(NxU32 index);
+	void AddSelectable(NxU32 index);
+	void RemoveSelectable(NxU32 index);
+
+	NxArray<Slot> m_slots;
+	NxU32 m_firstFree;
+	NxArray<NxActor*> m_dense;
+	NxArray<NxU32> m_denseSlots;	//slot of each dense entry
+	NxArray<NxU32> m_selectable;	//slots of the selectable actors
+};
+
+#endif // ACTORHANDLES_H
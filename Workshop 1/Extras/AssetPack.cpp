@@ -0,0 +1,224 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include <string.h>
+#include "NxPhysics.h"
+#include "AssetPack.h"
+#include "Stream.h"
+
+static const NxU32 ASSET_PACK_MAGIC = 0x4b415041;	//"APAK"
+static const NxU32 ASSET_PACK_VERSION = 1;
+static const NxU32 ASSET_DATA_ALIGNMENT = 16;
+
+NxU32 HashAssetName(const char* name)
+{
+	NxU32 hash = 2166136261u;
+	while (*name)
+	{
+		hash ^= (NxU8)*name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static NxU32 AlignOffset(NxU32 offset)
+{
+	return (offset + ASSET_DATA_ALIGNMENT - 1) & ~(ASSET_DATA_ALIGNMENT - 1);
+}
+
+AssetPackWriter::AssetPackWriter()
+{
+}
+
+AssetPackWriter::~AssetPackWriter()
+{
+	Clear();
+}
+
+bool AssetPackWriter::Add(const char* name, AssetType type, const void* data, NxU32 size)
+{
+	if (!name || !*name || type == ASSET_NONE || (size && !data)) return false;
+
+	PendingAsset asset;
+	NxU32 nameLength = (NxU32)strlen(name);
+	asset.name = new char[nameLength + 1];
+	memcpy(asset.name, name, nameLength + 1);
+	asset.type = type;
+	asset.hash = HashAssetName(name);
+	asset.size = size;
+	asset.data = size ? new NxU8[size] : 0;
+	if (size) memcpy(asset.data, data, size);
+	m_assets.pushBack(asset);
+	return true;
+}
+
+bool AssetPackWriter::Add(const char* name, AssetType type, const MemoryWriteBuffer& buffer)
+{
+	return Add(name, type, buffer.data, buffer.currentSize);
+}
+
+bool AssetPackWriter::Write(const char* filename) const
+{
+	//keep the table at most half full so probe sequences stay short
+	NxU32 nbSlots = 16;
+	while (nbSlots < m_assets.size()*2) nbSlots <<= 1;
+
+	NxArray<AssetPackSlot> slots;
+	AssetPackSlot empty = { 0, 0, 0, 0, ASSET_NONE };
+	slots.resize(nbSlots, empty);
+
+	AssetPackHeader header;
+	header.magic = ASSET_PACK_MAGIC;
+	header.version = ASSET_PACK_VERSION;
+	header.nbAssets = m_assets.size();
+	header.nbSlots = nbSlots;
+	header.namesOffset = sizeof(AssetPackHeader) + nbSlots*sizeof(AssetPackSlot);
+
+	NxU32 namesSize = 0;
+	for (NxU32 i = 0; i < m_assets.size(); i++)
+		namesSize += (NxU32)strlen(m_assets[i].name) + 1;
+	header.dataOffset = AlignOffset(header.namesOffset + namesSize);
+
+	//place each asset in the table
+	NxU32 nameOffset = header.namesOffset;
+	NxU32 dataOffset = header.dataOffset;
+	for (NxU32 i = 0; i < m_assets.size(); i++)
+	{
+		const PendingAsset& asset = m_assets[i];
+		NxU32 slot = asset.hash & (nbSlots - 1);
+		while (slots[slot].type != ASSET_NONE)
+		{
+			if (slots[slot].hash == asset.hash && !strcmp(m_assets[slots[slot].nameOffset].name, asset.name))
+				return false; //duplicate name
+			slot = (slot + 1) & (nbSlots - 1);
+		}
+		//nameOffset temporarily holds the asset index for the duplicate check above
+		slots[slot].hash = asset.hash;
+		slots[slot].nameOffset = i;
+		slots[slot].dataOffset = dataOffset;
+		slots[slot].size = asset.size;
+		slots[slot].type = asset.type;
+		dataOffset = AlignOffset(dataOffset + asset.size);
+	}
+
+	NxArray<NxU32> assetNameOffsets;
+	assetNameOffsets.resize(m_assets.size(), 0);
+	for (NxU32 i = 0; i < m_assets.size(); i++)
+	{
+		assetNameOffsets[i] = nameOffset;
+		nameOffset += (NxU32)strlen(m_assets[i].name) + 1;
+	}
+	for (NxU32 i = 0; i < nbSlots; i++)
+		if (slots[i].type != ASSET_NONE)
+			slots[i].nameOffset = assetNameOffsets[slots[i].nameOffset];
+
+	UserStream stream(filename, false);
+	if (!stream.fp) return false;
+
+	stream.storeBuffer(&header, sizeof(header));
+	stream.storeBuffer(&slots[0], nbSlots*sizeof(AssetPackSlot));
+	for (NxU32 i = 0; i < m_assets.size(); i++)
+		stream.storeBuffer(m_assets[i].name, (NxU32)strlen(m_assets[i].name) + 1);
+
+	static const NxU8 padding[ASSET_DATA_ALIGNMENT] = { 0 };
+	NxU32 offset = nameOffset;
+	for (NxU32 i = 0; i < m_assets.size(); i++)
+	{
+		NxU32 aligned = AlignOffset(offset);
+		if (aligned != offset) stream.storeBuffer(padding, aligned - offset);
+		if (m_assets[i].size) stream.storeBuffer(m_assets[i].data, m_assets[i].size);
+		offset = aligned + m_assets[i].size;
+	}
+
+	return true;
+}
+
+void AssetPackWriter::Clear()
+{
+	for (NxU32 i = 0; i < m_assets.size(); i++)
+	{
+		delete[] m_assets[i].name;
+		delete[] m_assets[i].data;
+	}
+	m_assets.clear();
+}
+
+AssetPack::AssetPack() : m_header(0), m_slots(0)
+{
+}
+
+bool AssetPack::Open(const char* filename)
+{
+	Close();
+	if (!m_file.Open(filename)) return false;
+
+	const NxU8* data = m_file.GetData();
+	NxU32 size = m_file.GetSize();
+	const AssetPackHeader* header = (const AssetPackHeader*)data;
+
+	//validate the header and table bounds once so lookups don't need to; the slot count is bounded
+	//by the file size before it's multiplied so the table size can't wrap
+	if (size < sizeof(AssetPackHeader) || header->magic != ASSET_PACK_MAGIC || header->version != ASSET_PACK_VERSION ||
+		!header->nbSlots || (header->nbSlots & (header->nbSlots - 1)) ||
+		header->nbSlots > (size - sizeof(AssetPackHeader))/sizeof(AssetPackSlot) ||
+		header->namesOffset != sizeof(AssetPackHeader) + header->nbSlots*sizeof(AssetPackSlot) ||
+		header->namesOffset > header->dataOffset || header->dataOffset > size)
+	{
+		m_file.Close();
+		return false;
+	}
+
+	//every name must end before the data, and a probe sequence must end at an empty slot
+	const AssetPackSlot* slots = (const AssetPackSlot*)(data + sizeof(AssetPackHeader));
+	bool hasEmptySlot = false;
+	for (NxU32 i = 0; i < header->nbSlots; i++)
+	{
+		const AssetPackSlot& slot = slots[i];
+		if (slot.type == ASSET_NONE)
+		{
+			hasEmptySlot = true;
+			continue;
+		}
+		if (slot.nameOffset < header->namesOffset || slot.nameOffset >= header->dataOffset ||
+			!memchr(data + slot.nameOffset, 0, header->dataOffset - slot.nameOffset) ||
+			slot.dataOffset > size || slot.size > size - slot.dataOffset)
+		{
+			m_file.Close();
+			return false;
+		}
+	}
+	if (!hasEmptySlot)
+	{
+		m_file.Close();
+		return false;
+	}
+
+	m_header = header;
+	m_slots = slots;
+	return true;
+}
+
+void AssetPack::Close()
+{
+	m_file.Close();
+	m_header = 0;
+	m_slots = 0;
+}
+
+const NxU8* AssetPack::Find(const char* name, NxU32* size, AssetType* type) const
+{
+	if (!m_header) return 0;
+
+	const char* base = (const char*)m_file.GetData();
+	NxU32 hash = HashAssetName(name);
+	NxU32 mask = m_header->nbSlots - 1;
+	for (NxU32 slot = hash & mask; m_slots[slot].type != ASSET_NONE; slot = (slot + 1) & mask)
+	{
+		const AssetPackSlot& entry = m_slots[slot];
+		if (entry.hash == hash && !strcmp(base + entry.nameOffset, name))
+		{
+			if (size) *size = entry.size;
+			if (type) *type = (AssetType)entry.type;
+			return m_file.GetData() + entry.dataOffset;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,109 @@
+/// \file AssetPack.h
+///
+/// \brief Single-file archive of cooked meshes, scene descriptors and render geometry with a hashed table of contents.
+///
+/// Layout: AssetPackHeader, a power-of-two table of AssetPackSlot (open addressing, linear probing),
+/// a block of zero-terminated names and the 16-byte aligned asset data. The reader maps the file
+/// once and resolves names in O(1) without copying; the data can be handed straight to a
+/// MemoryReadBuffer, e.g. for NxPhysicsSDK::createConvexMesh.
+///
+
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include "NxPhysics.h"
+#include "FileMapping.h"
+
+class MemoryWriteBuffer;
+
+enum AssetType
+{
+	ASSET_NONE = 0,
+	ASSET_COOKED_CONVEX,
+	ASSET_COOKED_TRIANGLE_MESH,
+	ASSET_SCENE_DESC,
+	ASSET_RENDER_GEOMETRY,
+	ASSET_RAW
+};
+
+struct AssetPackHeader
+{
+	NxU32 magic;
+	NxU32 version;
+	NxU32 nbAssets;
+	NxU32 nbSlots;
+	NxU32 namesOffset;
+	NxU32 dataOffset;
+};
+
+struct AssetPackSlot
+{
+	NxU32 hash;
+	NxU32 nameOffset;
+	NxU32 dataOffset;
+	NxU32 size;
+	NxU32 type;		//ASSET_NONE marks an empty slot
+};
+
+/// FNV-1a hash of an asset name.
+NxU32 HashAssetName(const char* name);
+
+///
+/// Collect assets in memory and write them out as one pack file.
+///
+class AssetPackWriter
+{
+public:
+	AssetPackWriter();
+	~AssetPackWriter();
+
+	/// Add a copy of the data. Names must be unique; Write() fails on duplicates.
+	bool Add(const char* name, AssetType type, const void* data, NxU32 size);
+
+	/// Add the contents of a memory stream, e.g. the output of a cooking job.
+	bool Add(const char* name, AssetType type, const MemoryWriteBuffer& buffer);
+
+	bool Write(const char* filename) const;
+	void Clear();
+
+	NxU32 GetNbAssets() const { return m_assets.size(); }
+
+private:
+	AssetPackWriter(const AssetPackWriter&);
+	AssetPackWriter& operator=(const AssetPackWriter&);
+
+	struct PendingAsset
+	{
+		char* name;
+		AssetType type;
+		NxU32 hash;
+		NxU8* data;
+		NxU32 size;
+	};
+	NxArray<PendingAsset> m_assets;
+};
+
+///
+/// Memory mapped pack file.
+///
+class AssetPack
+{
+public:
+	AssetPack();
+
+	bool Open(const char* filename);
+	void Close();
+
+	bool IsOpen() const { return m_header != 0; }
+	NxU32 GetNbAssets() const { return m_header ? m_header->nbAssets : 0; }
+
+	/// Look up an asset by name. Returns the data (valid while the pack is open) or 0 if not found.
+	const NxU8* Find(const char* name, NxU32* size = 0, AssetType* type = 0) const;
+
+private:
+	FileMapping m_file;
+	const AssetPackHeader* m_header;
+	const AssetPackSlot* m_slots;
+};
+
+#endif // ASSETPACK_H
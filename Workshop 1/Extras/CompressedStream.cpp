@@ -0,0 +1,472 @@
+#include <string.h>
+#include "NxPhysics.h"
+#include "CompressedStream.h"
+#include "Thread.h"
+
+static const NxU32 COMPRESSED_STREAM_MAGIC = 0x31425a4c;	//"LZB1"
+static const NxU32 COMPRESSED_MAX_BLOCK_SIZE = 16*1024*1024;
+static const NxU32 BLOCK_STORED_RAW = 0x80000000;			//set in the stored size of incompressible blocks
+
+//codec parameters, same limits as the LZ4 block format
+static const NxU32 MIN_MATCH = 4;
+static const NxU32 LAST_LITERALS = 5;
+static const NxU32 MATCH_FIND_LIMIT = 12;
+static const NxU32 MAX_OFFSET = 65535;
+static const NxU32 HASH_LOG = 12;
+
+static inline NxU32 Read32(const NxU8* p)
+{
+	NxU32 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline NxU32 HashSequence(NxU32 sequence)
+{
+	return (sequence * 2654435761u) >> (32 - HASH_LOG);
+}
+
+static inline NxU8* WriteLength(NxU8* op, NxU32 length)
+{
+	while (length >= 255)
+	{
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = (NxU8)length;
+	return op;
+}
+
+NxU32 GetMaxCompressedSize(NxU32 size)
+{
+	return size + size/255 + 16;
+}
+
+NxU32 CompressBlock(const NxU8* src, NxU32 srcSize, NxU8* dst, NxU32 dstCapacity)
+{
+	NxU32 table[1<<HASH_LOG];
+	memset(table, 0, sizeof(table));
+
+	const NxU8* ip = src;
+	const NxU8* anchor = src;
+	const NxU8* const end = src + srcSize;
+	const NxU8* const matchLimit = end - LAST_LITERALS;
+	const NxU8* const findLimit = end - MATCH_FIND_LIMIT;
+	NxU8* op = dst;
+	NxU8* const oend = dst + dstCapacity;
+
+	if (srcSize > MATCH_FIND_LIMIT)
+	{
+		while (ip < findLimit)
+		{
+			NxU32 sequence = Read32(ip);
+			NxU32 h = HashSequence(sequence);
+			const NxU8* ref = src + table[h];
+			table[h] = (NxU32)(ip - src);
+
+			if (ref >= ip || (NxU32)(ip - ref) > MAX_OFFSET || Read32(ref) != sequence)
+			{
+				//skip faster through data that doesn't compress
+				ip += 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+
+			const NxU8* matchEnd = ip + MIN_MATCH;
+			const NxU8* refEnd = ref + MIN_MATCH;
+			while (matchEnd < matchLimit && *matchEnd == *refEnd)
+			{
+				matchEnd++;
+				refEnd++;
+			}
+
+			NxU32 literalLength = (NxU32)(ip - anchor);
+			NxU32 matchLength = (NxU32)(matchEnd - ip) - MIN_MATCH;
+			if ((NxU32)(oend - op) < 1 + literalLength + literalLength/255 + 1 + 2 + matchLength/255 + 1)
+				return 0;
+
+			NxU8* token = op++;
+			*token = (NxU8)(((literalLength < 15 ? literalLength : 15) << 4) | (matchLength < 15 ? matchLength : 15));
+			if (literalLength >= 15) op = WriteLength(op, literalLength - 15);
+			memcpy(op, anchor, literalLength);
+			op += literalLength;
+
+			NxU32 offset = (NxU32)(ip - ref);
+			*op++ = (NxU8)(offset & 0xff);
+			*op++ = (NxU8)(offset >> 8);
+			if (matchLength >= 15) op = WriteLength(op, matchLength - 15);
+
+			ip = matchEnd;
+			anchor = ip;
+			if (ip < findLimit)
+				table[HashSequence(Read32(ip - 2))] = (NxU32)(ip - 2 - src);
+		}
+	}
+
+	//the remaining bytes are stored as literals
+	NxU32 literalLength = (NxU32)(end - anchor);
+	if ((NxU32)(oend - op) < 1 + literalLength + literalLength/255 + 1)
+		return 0;
+	NxU8* token = op++;
+	*token = (NxU8)((literalLength < 15 ? literalLength : 15) << 4);
+	if (literalLength >= 15) op = WriteLength(op, literalLength - 15);
+	memcpy(op, anchor, literalLength);
+	op += literalLength;
+
+	return (NxU32)(op - dst);
+}
+
+static inline bool ReadLength(const NxU8*& ip, const NxU8* iend, NxU32& length)
+{
+	NxU8 b;
+	do
+	{
+		if (ip >= iend) return false;
+		b = *ip++;
+		length += b;
+	} while (b == 255);
+	return true;
+}
+
+bool DecompressBlock(const NxU8* src, NxU32 srcSize, NxU8* dst, NxU32 dstSize)
+{
+	const NxU8* ip = src;
+	const NxU8* const iend = src + srcSize;
+	NxU8* op = dst;
+	NxU8* const oend = dst + dstSize;
+
+	while (ip < iend)
+	{
+		NxU8 token = *ip++;
+
+		NxU32 literalLength = token >> 4;
+		if (literalLength == 15 && !ReadLength(ip, iend, literalLength)) return false;
+		if (literalLength > (NxU32)(iend - ip) || literalLength > (NxU32)(oend - op)) return false;
+		memcpy(op, ip, literalLength);
+		op += literalLength;
+		ip += literalLength;
+
+		//the last sequence has no match
+		if (ip == iend) break;
+
+		if (iend - ip < 2) return false;
+		NxU32 offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (NxU32)(op - dst)) return false;
+
+		NxU32 matchLength = token & 15;
+		if (matchLength == 15 && !ReadLength(ip, iend, matchLength)) return false;
+		matchLength += MIN_MATCH;
+		if (matchLength > (NxU32)(oend - op)) return false;
+
+		const NxU8* match = op - offset;
+		if (offset >= matchLength)
+		{
+			memcpy(op, match, matchLength);
+			op += matchLength;
+		}
+		else
+		{
+			//overlapping copy repeats the last offset bytes
+			while (matchLength--) *op++ = *match++;
+		}
+	}
+
+	return op == oend;
+}
+
+///
+/// Location of one block inside an in-memory compressed stream.
+///
+struct CompressedBlockInfo
+{
+	const NxU8* src;
+	NxU32 storedSize;
+	bool raw;
+	NxU8* dst;
+	NxU32 rawSize;
+	bool ok;
+};
+
+///
+/// Walk the block headers of an image. If blocks is given the block locations are appended to it.
+///
+static bool ScanImage(const NxU8* image, NxU32 imageSize, NxU32& totalSize, NxArray<CompressedBlockInfo>* blocks)
+{
+	totalSize = 0;
+	if (imageSize < 2*sizeof(NxU32) || Read32(image) != COMPRESSED_STREAM_MAGIC) return false;
+
+	NxU32 blockSize = Read32(image + 4);
+	if (!blockSize || blockSize > COMPRESSED_MAX_BLOCK_SIZE) return false;
+
+	const NxU8* ip = image + 2*sizeof(NxU32);
+	const NxU8* const iend = image + imageSize;
+	for (;;)
+	{
+		if (iend - ip < (int)sizeof(NxU32)) return false;
+		NxU32 rawSize = Read32(ip);
+		ip += sizeof(NxU32);
+		if (!rawSize) return true;
+
+		if (iend - ip < (int)sizeof(NxU32)) return false;
+		NxU32 stored = Read32(ip);
+		ip += sizeof(NxU32);
+
+		NxU32 storedSize = stored & ~BLOCK_STORED_RAW;
+		bool raw = (stored & BLOCK_STORED_RAW) != 0;
+		if (rawSize > blockSize || storedSize > (NxU32)(iend - ip) || (raw && storedSize != rawSize)) return false;
+
+		if (blocks)
+		{
+			CompressedBlockInfo info;
+			info.src = ip;
+			info.storedSize = storedSize;
+			info.raw = raw;
+			info.dst = 0;
+			info.rawSize = rawSize;
+			info.ok = false;
+			blocks->pushBack(info);
+		}
+
+		ip += storedSize;
+		totalSize += rawSize;
+	}
+}
+
+NxU32 GetDecompressedSize(const NxU8* image, NxU32 imageSize)
+{
+	NxU32 totalSize;
+	return ScanImage(image, imageSize, totalSize, 0) ? totalSize : 0;
+}
+
+static void DecodeImageBlock(void* context, NxU32 index)
+{
+	CompressedBlockInfo& block = ((CompressedBlockInfo*)context)[index];
+	if (block.raw)
+	{
+		memcpy(block.dst, block.src, block.rawSize);
+		block.ok = true;
+	}
+	else
+		block.ok = DecompressBlock(block.src, block.storedSize, block.dst, block.rawSize);
+}
+
+bool DecompressImage(const NxU8* image, NxU32 imageSize, NxU8* dst, NxU32 dstSize, NxU32 nbThreads)
+{
+	NxArray<CompressedBlockInfo> blocks;
+	NxU32 totalSize;
+	if (!ScanImage(image, imageSize, totalSize, &blocks) || totalSize != dstSize) return false;
+	if (!blocks.size()) return true;
+
+	NxU8* out = dst;
+	for (NxU32 i = 0; i < blocks.size(); i++)
+	{
+		blocks[i].dst = out;
+		out += blocks[i].rawSize;
+	}
+
+	ParallelFor(blocks.size(), DecodeImageBlock, &blocks[0], nbThreads);
+
+	for (NxU32 i = 0; i < blocks.size(); i++)
+		if (!blocks[i].ok) return false;
+	return true;
+}
+
+CompressedWriteStream::CompressedWriteStream(NxStream& output, NxU32 blockSize) :
+	m_output(output), m_blockSize(blockSize), m_rawSize(0), m_finished(false)
+{
+	if (!m_blockSize || m_blockSize > COMPRESSED_MAX_BLOCK_SIZE) m_blockSize = COMPRESSED_BLOCK_SIZE;
+	m_raw = new NxU8[m_blockSize];
+	m_packed = new NxU8[m_blockSize];
+
+	m_output.storeDword(COMPRESSED_STREAM_MAGIC);
+	m_output.storeDword(m_blockSize);
+}
+
+CompressedWriteStream::~CompressedWriteStream()
+{
+	Finish();
+	delete[] m_raw;
+	delete[] m_packed;
+}
+
+void CompressedWriteStream::Finish()
+{
+	if (m_finished) return;
+	FlushBlock();
+	m_output.storeDword(0);
+	m_finished = true;
+}
+
+void CompressedWriteStream::FlushBlock()
+{
+	if (!m_rawSize) return;
+
+	//only keep the compressed form if it is actually smaller
+	NxU32 packedSize = CompressBlock(m_raw, m_rawSize, m_packed, m_rawSize - 1);
+	m_output.storeDword(m_rawSize);
+	if (packedSize)
+	{
+		m_output.storeDword(packedSize);
+		m_output.storeBuffer(m_packed, packedSize);
+	}
+	else
+	{
+		m_output.storeDword(m_rawSize | BLOCK_STORED_RAW);
+		m_output.storeBuffer(m_raw, m_rawSize);
+	}
+	m_rawSize = 0;
+}
+
+NxStream& CompressedWriteStream::storeByte(NxU8 b)
+{
+	return storeBuffer(&b, sizeof(NxU8));
+}
+
+NxStream& CompressedWriteStream::storeWord(NxU16 w)
+{
+	return storeBuffer(&w, sizeof(NxU16));
+}
+
+NxStream& CompressedWriteStream::storeDword(NxU32 d)
+{
+	return storeBuffer(&d, sizeof(NxU32));
+}
+
+NxStream& CompressedWriteStream::storeFloat(NxReal f)
+{
+	return storeBuffer(&f, sizeof(NxReal));
+}
+
+NxStream& CompressedWriteStream::storeDouble(NxF64 f)
+{
+	return storeBuffer(&f, sizeof(NxF64));
+}
+
+NxStream& CompressedWriteStream::storeBuffer(const void* buffer, NxU32 size)
+{
+	NX_ASSERT(!m_finished);
+	const NxU8* src = (const NxU8*)buffer;
+	while (size)
+	{
+		NxU32 chunk = m_blockSize - m_rawSize;
+		if (chunk > size) chunk = size;
+		memcpy(m_raw + m_rawSize, src, chunk);
+		m_rawSize += chunk;
+		src += chunk;
+		size -= chunk;
+		if (m_rawSize == m_blockSize) FlushBlock();
+	}
+	return *this;
+}
+
+CompressedReadStream::CompressedReadStream(const NxStream& input) :
+	m_input(input), m_raw(0), m_packed(0), m_blockSize(0), m_rawSize(0), m_position(0), m_valid(false), m_ended(true)
+{
+	if (m_input.readDword() != COMPRESSED_STREAM_MAGIC) return;
+
+	m_blockSize = m_input.readDword();
+	if (!m_blockSize || m_blockSize > COMPRESSED_MAX_BLOCK_SIZE) return;
+
+	m_raw = new NxU8[m_blockSize];
+	m_packed = new NxU8[m_blockSize];
+	m_valid = true;
+	m_ended = false;
+}
+
+CompressedReadStream::~CompressedReadStream()
+{
+	delete[] m_raw;
+	delete[] m_packed;
+}
+
+bool CompressedReadStream::NextBlock() const
+{
+	if (m_ended || !m_valid) return false;
+
+	NxU32 rawSize = m_input.readDword();
+	if (!rawSize)
+	{
+		m_ended = true;
+		return false;
+	}
+
+	NxU32 stored = m_input.readDword();
+	NxU32 storedSize = stored & ~BLOCK_STORED_RAW;
+	if (rawSize > m_blockSize || storedSize > m_blockSize)
+	{
+		m_valid = false;
+		return false;
+	}
+
+	if (stored & BLOCK_STORED_RAW)
+	{
+		m_input.readBuffer(m_raw, storedSize);
+		m_valid = (storedSize == rawSize);
+	}
+	else
+	{
+		m_input.readBuffer(m_packed, storedSize);
+		m_valid = DecompressBlock(m_packed, storedSize, m_raw, rawSize);
+	}
+
+	m_rawSize = rawSize;
+	m_position = 0;
+	return m_valid;
+}
+
+NxU8 CompressedReadStream::readByte() const
+{
+	NxU8 b;
+	readBuffer(&b, sizeof(NxU8));
+	return b;
+}
+
+NxU16 CompressedReadStream::readWord() const
+{
+	NxU16 w;
+	readBuffer(&w, sizeof(NxU16));
+	return w;
+}
+
+NxU32 CompressedReadStream::readDword() const
+{
+	NxU32 d;
+	readBuffer(&d, sizeof(NxU32));
+	return d;
+}
+
+float CompressedReadStream::readFloat() const
+{
+	float f;
+	readBuffer(&f, sizeof(float));
+	return f;
+}
+
+double CompressedReadStream::readDouble() const
+{
+	double f;
+	readBuffer(&f, sizeof(double));
+	return f;
+}
+
+void CompressedReadStream::readBuffer(void* buffer, NxU32 size) const
+{
+	NxU8* dst = (NxU8*)buffer;
+	while (size)
+	{
+		if (m_position == m_rawSize && !NextBlock())
+		{
+			//reading past the end or from a corrupt stream
+			NX_ASSERT(0);
+			memset(dst, 0, size);
+			return;
+		}
+
+		NxU32 chunk = m_rawSize - m_position;
+		if (chunk > size) chunk = size;
+		memcpy(dst, m_raw + m_position, chunk);
+		m_position += chunk;
+		dst += chunk;
+		size -= chunk;
+	}
+}
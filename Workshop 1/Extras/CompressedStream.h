@@ -0,0 +1,109 @@
+/// \file CompressedStream.h
+///
+/// \brief LZ4-style block compression and NxStream wrappers that apply it transparently.
+///
+/// A compressed stream is a small header followed by independent blocks, each with its own
+/// raw and stored size, and a terminating zero-sized block. Blocks never reference data of
+/// other blocks, so an in-memory image can be decoded in parallel with DecompressImage.
+///
+
+#ifndef COMPRESSEDSTREAM_H
+#define COMPRESSEDSTREAM_H
+
+#include "NxStream.h"
+
+/// Default amount of raw data per block.
+static const NxU32 COMPRESSED_BLOCK_SIZE = 64*1024;
+
+/// Worst-case output size of CompressBlock for a given input size.
+NxU32 GetMaxCompressedSize(NxU32 size);
+
+/// Compress a buffer. Returns the compressed size, or 0 if the result would not fit in dstCapacity.
+NxU32 CompressBlock(const NxU8* src, NxU32 srcSize, NxU8* dst, NxU32 dstCapacity);
+
+/// Decompress a buffer produced by CompressBlock. Returns false on corrupt input.
+bool DecompressBlock(const NxU8* src, NxU32 srcSize, NxU8* dst, NxU32 dstSize);
+
+/// Total raw size of an in-memory compressed stream, or 0 if the image is invalid.
+NxU32 GetDecompressedSize(const NxU8* image, NxU32 imageSize);
+
+/// Decode a whole in-memory compressed stream, with blocks spread over up to nbThreads threads (0 = one per core).
+bool DecompressImage(const NxU8* image, NxU32 imageSize, NxU8* dst, NxU32 dstSize, NxU32 nbThreads = 0);
+
+///
+/// Write-only stream that compresses everything stored into it and forwards the blocks to another stream.
+///
+class CompressedWriteStream : public NxStream
+{
+public:
+								CompressedWriteStream(NxStream& output, NxU32 blockSize = COMPRESSED_BLOCK_SIZE);
+	virtual						~CompressedWriteStream();
+
+	/// Flush the pending block and write the end marker. Called by the destructor if needed.
+				void			Finish();
+
+	virtual		NxU8			readByte()								const	{ NX_ASSERT(0);	return 0;	}
+	virtual		NxU16			readWord()								const	{ NX_ASSERT(0);	return 0;	}
+	virtual		NxU32			readDword()								const	{ NX_ASSERT(0);	return 0;	}
+	virtual		float			readFloat()								const	{ NX_ASSERT(0);	return 0.0f;}
+	virtual		double			readDouble()							const	{ NX_ASSERT(0);	return 0.0;	}
+	virtual		void			readBuffer(void* /*buffer*/, NxU32 /*size*/)	const	{ NX_ASSERT(0);				}
+
+	virtual		NxStream&		storeByte(NxU8 b);
+	virtual		NxStream&		storeWord(NxU16 w);
+	virtual		NxStream&		storeDword(NxU32 d);
+	virtual		NxStream&		storeFloat(NxReal f);
+	virtual		NxStream&		storeDouble(NxF64 f);
+	virtual		NxStream&		storeBuffer(const void* buffer, NxU32 size);
+
+private:
+				void			FlushBlock();
+
+				NxStream&		m_output;
+				NxU8*			m_raw;
+				NxU8*			m_packed;
+				NxU32			m_blockSize;
+				NxU32			m_rawSize;
+				bool			m_finished;
+};
+
+///
+/// Read-only stream that decodes a compressed stream read from another stream.
+///
+class CompressedReadStream : public NxStream
+{
+public:
+								CompressedReadStream(const NxStream& input);
+	virtual						~CompressedReadStream();
+
+	/// False if the header or a block was corrupt.
+				bool			IsValid() const { return m_valid; }
+
+	virtual		NxU8			readByte()								const;
+	virtual		NxU16			readWord()								const;
+	virtual		NxU32			readDword()								const;
+	virtual		float			readFloat()								const;
+	virtual		double			readDouble()							const;
+	virtual		void			readBuffer(void* buffer, NxU32 size)	const;
+
+	virtual		NxStream&		storeByte(NxU8 /*b*/)							{ NX_ASSERT(0);	return *this;	}
+	virtual		NxStream&		storeWord(NxU16 /*w*/)							{ NX_ASSERT(0);	return *this;	}
+	virtual		NxStream&		storeDword(NxU32 /*d*/)							{ NX_ASSERT(0);	return *this;	}
+	virtual		NxStream&		storeFloat(NxReal /*f*/)						{ NX_ASSERT(0);	return *this;	}
+	virtual		NxStream&		storeDouble(NxF64 /*f*/)						{ NX_ASSERT(0);	return *this;	}
+	virtual		NxStream&		storeBuffer(const void* /*buffer*/, NxU32 /*size*/)	{ NX_ASSERT(0);	return *this;	}
+
+private:
+				bool			NextBlock() const;
+
+				const NxStream&	m_input;
+				NxU8*			m_raw;
+				NxU8*			m_packed;
+				NxU32			m_blockSize;
+	mutable		NxU32			m_rawSize;
+	mutable		NxU32			m_position;
+	mutable		bool			m_valid;
+	mutable		bool			m_ended;
+};
+
+#endif // COMPRESSEDSTREAM_H
@@ -0,0 +1,35 @@
+#include "NxPhysics.h"
+#include "ContactReport.h"
+
+ContactReport::ContactReport(NxU32 capacity) :
+	m_nbEvents(0), m_nbDropped(0), m_eventMask(NX_NOTIFY_ON_START_TOUCH | NX_NOTIFY_ON_END_TOUCH)
+{
+	m_events.resize(capacity ? capacity : 1);
+}
+
+void ContactReport::Attach(NxScene& scene, NxU32 eventMask)
+{
+	m_eventMask = eventMask;
+	Clear();
+	scene.setUserContactReport(this);
+	scene.setActorGroupPairFlags(0, 0, eventMask);
+}
+
+void ContactReport::onContactNotify(NxContactPair& pair, NxU32 events)
+{
+	events &= m_eventMask;
+	if (!events) return;
+
+	if (m_nbEvents == m_events.size())
+	{
+		m_nbDropped++;
+		return;
+	}
+
+	ContactEvent& event = m_events[m_nbEvents++];
+	event.actors[0] = pair.isDeletedActor[0] ? NULL : pair.actors[0];
+	event.actors[1] = pair.isDeletedActor[1] ? NULL : pair.actors[1];
+	event.events = events;
+	event.normalForce = pair.sumNormalForce;
+	event.frictionForce = pair.sumFrictionForce;
+}
@@ -0,0 +1,59 @@
+/// \file ContactReport.h
+///
+/// \brief Contact notifications collected into a per-frame buffer.
+///
+
+#ifndef CONTACTREPORT_H
+#define CONTACTREPORT_H
+
+#include "NxPhysics.h"
+
+///
+/// One contact notification for a pair of actors.
+///
+struct ContactEvent
+{
+	NxActor* actors[2];		//NULL if the actor was deleted
+	NxU32 events;			//NxContactPairFlag
+	NxVec3 normalForce;		//only with NX_NOTIFY_FORCES
+	NxVec3 frictionForce;
+};
+
+///
+/// Contact report that appends the notifications of a step to a buffer read in one batch.
+///
+/// The buffer is allocated up front: onContactNotify only copies the pair into it and drops
+/// the event, counting it, once the buffer is full. The event mask is applied both as the
+/// actor group pair flags, so PhysX doesn't generate unwanted events, and in the callback, for
+/// pairs with flags set elsewhere. Events are added during fetchResults; read them afterwards
+/// and call Clear before the next fetchResults.
+///
+class ContactReport : public NxUserContactReport
+{
+public:
+	ContactReport(NxU32 capacity = 4096);
+
+	/// Register with the scene and report the given events between actors of group 0.
+	void Attach(NxScene& scene, NxU32 eventMask = NX_NOTIFY_ON_START_TOUCH | NX_NOTIFY_ON_END_TOUCH);
+
+	void SetEventMask(NxU32 eventMask) { m_eventMask = eventMask; }
+	NxU32 GetEventMask() const { return m_eventMask; }
+
+	virtual void onContactNotify(NxContactPair& pair, NxU32 events);
+
+	NxU32 GetNbEvents() const { return m_nbEvents; }
+	const ContactEvent* GetEvents() const { return m_nbEvents ? &m_events[0] : 0; }
+
+	/// Events dropped because the buffer was full, since the last Clear.
+	NxU32 GetNbDropped() const { return m_nbDropped; }
+
+	void Clear() { m_nbEvents = 0; m_nbDropped = 0; }
+
+private:
+	NxArray<ContactEvent> m_events;
+	NxU32 m_nbEvents;
+	NxU32 m_nbDropped;
+	NxU32 m_eventMask;
+};
+
+#endif // CONTACTREPORT_H
@@ -0,0 +1,117 @@
+#include "NxPhysics.h"
+#include "NxCooking.h"
+#include "CookingBatch.h"
+#include "Stream.h"
+#include "Thread.h"
+
+//the cooking library is one process-wide object without documented thread safety, a batch holds
+//it from NxInitCooking to NxCloseCooking
+static Mutex gCookingLock;
+
+MeshCookingBatch::MeshCookingBatch()
+{
+}
+
+MeshCookingBatch::~MeshCookingBatch()
+{
+	Clear();
+}
+
+NxU32 MeshCookingBatch::AddConvexMesh(const NxConvexMeshDesc& desc)
+{
+	Job* job = new Job;
+	job->type = JOB_CONVEX;
+	job->convexDesc = desc;
+	job->buffer = 0;
+	job->cooked = false;
+	job->convexMesh = 0;
+	job->triangleMesh = 0;
+	m_jobs.pushBack(job);
+	return m_jobs.size() - 1;
+}
+
+NxU32 MeshCookingBatch::AddTriangleMesh(const NxTriangleMeshDesc& desc)
+{
+	Job* job = new Job;
+	job->type = JOB_TRIANGLE_MESH;
+	job->triangleDesc = desc;
+	job->buffer = 0;
+	job->cooked = false;
+	job->convexMesh = 0;
+	job->triangleMesh = 0;
+	m_jobs.pushBack(job);
+	return m_jobs.size() - 1;
+}
+
+bool MeshCookingBatch::Cook()
+{
+	if (!m_jobs.size()) return true;
+
+	//another batch can't change the parameters or close the library under this one
+	ScopedLock lock(gCookingLock);
+	NxCookingInterface* cooking = NxGetCookingLib(NX_PHYSICS_SDK_VERSION);
+	if (!cooking || !cooking->NxInitCooking()) return false;
+
+	for (NxU32 i = 0; i < m_jobs.size(); i++)
+	{
+		Job* job = m_jobs[i];
+		if (job->cooked) continue;
+
+		bool convex = job->type == JOB_CONVEX;
+		if (convex ? !job->convexDesc.isValid() : !job->triangleDesc.isValid()) continue;
+
+		if (!job->buffer) job->buffer = new MemoryWriteBuffer;
+		if (convex)
+			job->cooked = cooking->NxCookConvexMesh(job->convexDesc, *job->buffer);
+		else
+			job->cooked = cooking->NxCookTriangleMesh(job->triangleDesc, *job->buffer);
+	}
+
+	cooking->NxCloseCooking();
+
+	bool success = true;
+	for (NxU32 i = 0; i < m_jobs.size(); i++)
+		success &= m_jobs[i]->cooked;
+	return success;
+}
+
+void MeshCookingBatch::CreateMeshes(NxPhysicsSDK& sdk)
+{
+	for (NxU32 i = 0; i < m_jobs.size(); i++)
+	{
+		Job* job = m_jobs[i];
+		if (!job->buffer) continue;
+
+		if (job->cooked)
+		{
+			MemoryReadBuffer readBuffer(job->buffer->data);
+			if (job->type == JOB_CONVEX)
+				job->convexMesh = sdk.createConvexMesh(readBuffer);
+			else
+				job->triangleMesh = sdk.createTriangleMesh(readBuffer);
+		}
+
+		delete job->buffer;
+		job->buffer = 0;
+	}
+}
+
+NxConvexMesh* MeshCookingBatch::GetConvexMesh(NxU32 job) const
+{
+	return job < m_jobs.size() ? m_jobs[job]->convexMesh : 0;
+}
+
+NxTriangleMesh* MeshCookingBatch::GetTriangleMesh(NxU32 job) const
+{
+	return job < m_jobs.size() ? m_jobs[job]->triangleMesh : 0;
+}
+
+void MeshCookingBatch::Clear()
+{
+	for (NxU32 i = 0; i < m_jobs.size(); i++)
+	{
+		delete m_jobs[i]->buffer;
+		delete m_jobs[i];
+	}
+	m_jobs.clear();
+}
@@ -0,0 +1,75 @@
+/// \file CookingBatch.h
+///
+/// \brief Cook batches of convex and triangle meshes, then create the SDK meshes on the main thread.
+///
+
+#ifndef COOKINGBATCH_H
+#define COOKINGBATCH_H
+
+#include "NxPhysics.h"
+
+class MemoryWriteBuffer;
+
+///
+/// Batch of mesh cooking jobs, cooked one after the other.
+///
+/// Meshes are queued with AddConvexMesh/AddTriangleMesh, cooked by Cook() into one
+/// MemoryWriteBuffer per job, and turned into SDK objects by CreateMeshes(), which is the only
+/// step that touches the SDK and must run on the main thread. Cook() can run on a loading
+/// thread while the main thread does something else, but the jobs themselves are cooked
+/// serially: the 2.8 cooking library is a single process-wide object with global parameters
+/// and no documented thread safety, so one Cook() at a time holds it for the whole batch.
+///
+class MeshCookingBatch
+{
+public:
+	MeshCookingBatch();
+	~MeshCookingBatch();
+
+	/// Queue a convex mesh. The descriptor's vertex and index data must stay valid until Cook() returns.
+	NxU32 AddConvexMesh(const NxConvexMeshDesc& desc);
+
+	/// Queue a triangle mesh. The descriptor's vertex and index data must stay valid until Cook() returns.
+	NxU32 AddTriangleMesh(const NxTriangleMeshDesc& desc);
+
+	/// Cook all queued meshes in order. Returns false if any job failed, including jobs with an
+	/// invalid descriptor.
+	bool Cook();
+
+	/// Create the SDK meshes from the cooked buffers and free the buffers.
+	void CreateMeshes(NxPhysicsSDK& sdk);
+
+	/// Mesh created for a job, or 0 if the job is of the other type or failed.
+	NxConvexMesh* GetConvexMesh(NxU32 job) const;
+	NxTriangleMesh* GetTriangleMesh(NxU32 job) const;
+
+	NxU32 GetNbJobs() const { return m_jobs.size(); }
+
+	/// Drop all jobs. Created meshes are owned by the SDK and are not released.
+	void Clear();
+
+	enum JobType
+	{
+		JOB_CONVEX,
+		JOB_TRIANGLE_MESH
+	};
+
+	struct Job
+	{
+		JobType type;
+		NxConvexMeshDesc convexDesc;
+		NxTriangleMeshDesc triangleDesc;
+		MemoryWriteBuffer* buffer;
+		bool cooked;
+		NxConvexMesh* convexMesh;
+		NxTriangleMesh* triangleMesh;
+	};
+
+private:
+	MeshCookingBatch(const MeshCookingBatch&);
+	MeshCookingBatch& operator=(const MeshCookingBatch&);
+
+	NxArray<Job*> m_jobs;
+};
+
+#endif // COOKINGBATCH_H
@@ -249,8 +249,11 @@ void DrawWirePlane(NxShape* plane, const NxVec3& color)
 
 void DrawPlane(NxShape* plane)
 {
-	NxMat34 pose =	plane->getGlobalPose();
+	DrawPlane(plane, plane->getGlobalPose());
+}
 
+static void DrawPlane(NxMat34 pose)
+{
 	glPushMatrix();
 	glDisable(GL_LIGHTING);
 	glColor4f(0.1f, 0.2f, 0.3f, 1.0f);
@@ -263,6 +266,11 @@ void DrawPlane(NxShape* plane)
 	glPopMatrix();
 }
 
+void DrawPlane(NxShape* plane, NxMat34 pose)
+{
+	DrawPlane(pose);
+}
+
 void DrawWireBox(const NxBox& obb, const NxVec3& color, float lineWidth)
 {
 	// Compute obb vertices
@@ -287,18 +295,25 @@ void DrawWireBox(NxShape* box, const NxVec3& color, float lineWidth)
 	DrawWireBox(obb, color, lineWidth);
 }
 
-void DrawBox(NxShape* box)
+static void DrawBox(const NxMat34& pose, const NxVec3& boxDim)
 {
-	NxMat34 pose = box->getGlobalPose();
-
 	glPushMatrix();
 	SetupGLMatrix(pose.t, pose.M);
-	NxVec3 boxDim = box->isBox()->getDimensions();
 	glScalef(boxDim.x, boxDim.y, boxDim.z);
 	RenderBox();
 	glPopMatrix();
 }
 
+void DrawBox(NxShape* box)
+{
+	DrawBox(box, box->getGlobalPose());
+}
+
+void DrawBox(NxShape* box, const NxMat34& pose)
+{
+	DrawBox(pose, box->isBox()->getDimensions());
+}
+
 void DrawWireSphere(NxShape* sphere, const NxVec3& color)
 {
 	NxMat34 pose = sphere->getGlobalPose();
@@ -352,18 +367,25 @@ void DrawWireSphere(NxSphere* sphere, const NxVec3& color)
 	glPopMatrix();
 }
 
-void DrawSphere(NxShape* sphere)
+static void DrawSphere(const NxMat34& pose, NxReal r)
 {
-	NxMat34 pose = sphere->getGlobalPose();
-
 	glPushMatrix();
 	SetupGLMatrix(pose.t, pose.M);
-	NxReal r = sphere->isSphere()->getRadius();
 	glScalef(r,r,r);
 	RenderSphere();
 	glPopMatrix();
 }
 
+void DrawSphere(NxShape* sphere)
+{
+	DrawSphere(sphere, sphere->getGlobalPose());
+}
+
+void DrawSphere(NxShape* sphere, const NxMat34& pose)
+{
+	DrawSphere(pose, sphere->isSphere()->getRadius());
+}
+
 void DrawWireCapsule(NxShape* capsule, const NxVec3& color)
 {
 	NxMat34 pose = capsule->getGlobalPose();
@@ -502,13 +524,8 @@ void DrawWireCapsule(const NxCapsule& capsule, const NxVec3& color)
 	DrawCircle(20, pose, color, r);
 }
 
-void DrawCapsule(NxShape* capsule)
+static void DrawCapsule(const NxMat34& pose, NxReal r, NxReal h)
 {
-	NxMat34 pose = capsule->getGlobalPose();
-
-	const NxReal & r = capsule->isCapsule()->getRadius();
-	const NxReal & h = capsule->isCapsule()->getHeight();
-
 	glPushMatrix();
 	SetupGLMatrix(pose.t, pose.M);
 
@@ -534,6 +551,16 @@ void DrawCapsule(NxShape* capsule)
 	glPopMatrix();
 }
 
+void DrawCapsule(NxShape* capsule)
+{
+	DrawCapsule(capsule, capsule->getGlobalPose());
+}
+
+void DrawCapsule(NxShape* capsule, const NxMat34& pose)
+{
+	DrawCapsule(pose, capsule->isCapsule()->getRadius(), capsule->isCapsule()->getHeight());
+}
+
 void DrawCapsule(const NxVec3& color, NxF32 r, NxF32 h)
 {
 	glColor4f(color.x, color.y, color.z, 1.0f);
@@ -570,9 +597,8 @@ void DrawWireConvex(NxShape* mesh, const NxVec3& color, bool useShapeUserData)
 
 	void* ptr = NULL;
 	if (useShapeUserData) {
-		ShapeUserData* sud = (ShapeUserData*)(mesh->userData);
-		ptr = sud->mesh;
-		if (!(sud && sud->mesh))  return;
+		ptr = GetShapeMeshDesc((ShapeUserData*)(mesh->userData));
+		if (!ptr)  return;
 	} else {
 		ptr = mesh->userData;
 	}
@@ -670,7 +696,31 @@ void DrawTriangleList(int iTriangleCount, Triangle *pTriangles, Point *pPoints)
 	glDisableClientState(GL_NORMAL_ARRAY);
 }
 
+static void DrawTriangleList(const NxMat34& pose, NxU32 nbTriangles, const void* triangles, const void* points)
+{
+	glPushMatrix();
+
+	float glmat[16];	//4x4 column major matrix for OpenGL.
+	pose.M.getColumnMajorStride4(&(glmat[0]));
+	pose.t.get(&(glmat[12]));
+
+	//clear the elements we don't need:
+	glmat[3] = glmat[7] = glmat[11] = 0.0f;
+	glmat[15] = 1.0f;
+
+	glMultMatrixf(&(glmat[0]));
+
+	DrawTriangleList(nbTriangles, (Triangle *)triangles, (Point *)points);
+	
+	glPopMatrix();
+}
+
 void DrawConvex(NxShape* mesh, bool useShapeUserData)
+{
+	DrawConvex(mesh, mesh->getGlobalPose(), useShapeUserData);
+}
+
+void DrawConvex(NxShape* mesh, const NxMat34& pose, bool useShapeUserData)
 {
 	NxConvexMeshDesc meshDesc;
 
@@ -678,9 +728,8 @@ void DrawConvex(NxShape* mesh, bool useShapeUserData)
 
 	void* ptr = NULL;
 	if (useShapeUserData) {
-		ShapeUserData* sud = (ShapeUserData*)(mesh->userData);
-		ptr = sud->mesh;
-		if (!(sud && sud->mesh))  return;
+		ptr = GetShapeMeshDesc((ShapeUserData*)(mesh->userData));
+		if (!ptr)  return;
 
 		meshDesc = *((NxConvexMeshDesc*)(ptr));
 	} else {
@@ -704,29 +753,7 @@ void DrawConvex(NxShape* mesh, bool useShapeUserData)
 	}
 	**/
 
-	NxMat34 pose = mesh->getGlobalPose();
-
-	NxU32 nbVerts = meshDesc.numVertices;
-	NxU32 nbTriangles = meshDesc.numTriangles;
-
-	Point* points = (Point *)meshDesc.points;
-	Triangle* triangles = (Triangle *)meshDesc.triangles;
-
-	glPushMatrix();
-
-	float glmat[16];	//4x4 column major matrix for OpenGL.
-	pose.M.getColumnMajorStride4(&(glmat[0]));
-	pose.t.get(&(glmat[12]));
-
-	//clear the elements we don't need:
-	glmat[3] = glmat[7] = glmat[11] = 0.0f;
-	glmat[15] = 1.0f;
-
-	glMultMatrixf(&(glmat[0]));
-
-	DrawTriangleList(nbTriangles, triangles, points);
-	
-	glPopMatrix();
+	DrawTriangleList(pose, meshDesc.numTriangles, meshDesc.triangles, meshDesc.points);
 }
 
 void DrawWireMesh(NxShape* mesh, const NxVec3& color, bool useShapeUserData)
@@ -737,9 +764,8 @@ void DrawWireMesh(NxShape* mesh, const NxVec3& color, bool useShapeUserData)
 
 	void* ptr = NULL;
 	if (useShapeUserData) {
-		ShapeUserData* sud = (ShapeUserData*)(mesh->userData);
-		ptr = sud->mesh;
-		if (!(sud && sud->mesh))  return;
+		ptr = GetShapeMeshDesc((ShapeUserData*)(mesh->userData));
+		if (!ptr)  return;
 	} else {
 		ptr = mesh->userData;
 	}
@@ -855,17 +881,50 @@ void DrawHeightfield(NxShape* hf)
 	glColor4f(1,1,1,1);
 }
 
+// Heightfield from the triangles saved in its user data, they are in shape space
+static void DrawHeightFieldData(const NxMat34& pose, const HeightFieldData& data)
+{
+	if (!data.vertices.size()) return;
+
+	glPushMatrix();
+
+	float glmat[16];	//4x4 column major matrix for OpenGL.
+	pose.M.getColumnMajorStride4(&(glmat[0]));
+	pose.t.get(&(glmat[12]));
+
+	//clear the elements we don't need:
+	glmat[3] = glmat[7] = glmat[11] = 0.0f;
+	glmat[15] = 1.0f;
+
+	glMultMatrixf(&(glmat[0]));
+
+	glColor4f(0.1,0.1,0.7,1);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(NxVec3), &data.vertices[0]);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glNormalPointer(GL_FLOAT, sizeof(NxVec3), &data.normals[0]);
+	glDrawArrays(GL_TRIANGLES, 0, data.vertices.size());
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glColor4f(1,1,1,1);
+
+	glPopMatrix();
+}
+
 void DrawMesh(NxShape* mesh, bool useShapeUserData)
 {
-	if(mesh->userData == NULL) return;
+	DrawMesh(mesh, mesh->getGlobalPose(), useShapeUserData);
+}
 
-	NxMat34 pose = mesh->getGlobalPose();
+void DrawMesh(NxShape* mesh, const NxMat34& pose, bool useShapeUserData)
+{
+	if(mesh->userData == NULL) return;
 
 	void* ptr = NULL;
 	if (useShapeUserData) {
-		ShapeUserData* sud = (ShapeUserData*)(mesh->userData);
-		ptr = sud->mesh;
-		if (!(sud && sud->mesh))  return;
+		ptr = GetShapeMeshDesc((ShapeUserData*)(mesh->userData));
+		if (!ptr)  return;
 	} else {
 		ptr = mesh->userData;
 	}
@@ -873,12 +932,12 @@ void DrawMesh(NxShape* mesh, bool useShapeUserData)
 	NxTriangleMeshDesc meshDesc = *((NxTriangleMeshDesc*)(ptr));
 //	mesh->isTriangleMesh()->getTriangleMesh().saveToDesc(meshDesc);	
 
-	NxU32 nbVerts = meshDesc.numVertices;
-	NxU32 nbTriangles = meshDesc.numTriangles;
-
-	Point* points = (Point *)meshDesc.points;
-	Triangle* triangles = (Triangle *)meshDesc.triangles;
+	DrawTriangleList(pose, meshDesc.numTriangles, meshDesc.triangles, meshDesc.points);
+}
 
+// Wheel rolled about its axle, the local x axis
+static void DrawWheel(const NxMat34& pose, NxReal r, NxReal width, NxReal rollAngle)
+{
 	glPushMatrix();
 
 	float glmat[16];	//4x4 column major matrix for OpenGL.
@@ -891,8 +950,12 @@ void DrawMesh(NxShape* mesh, bool useShapeUserData)
 
 	glMultMatrixf(&(glmat[0]));
 
-	DrawTriangleList(nbTriangles, triangles, points);
-	
+	glRotatef(NxMath::radToDeg(rollAngle),1,0,0);
+	glRotatef(90,0,1,0);
+	glTranslatef(0,0,-width/2);
+	glScalef(r, r, width);
+	RenderCylinder();
+
 	glPopMatrix();
 }
 
@@ -905,26 +968,11 @@ void DrawWheelShape(NxShape* wheel)
 
 		float r = ws->getRadius();
 
-		NxMat34 pose = ((ShapeUserData*)(ws->userData))->wheelShapePose;
+		WheelShapeData* wheelData = GetWheelShapeData((ShapeUserData*)(ws->userData));
+		if (!wheelData) return;
 
-		glPushMatrix();
-
-		float glmat[16];	//4x4 column major matrix for OpenGL.
-		pose.M.getColumnMajorStride4(&(glmat[0]));
-		pose.t.get(&(glmat[12]));
-
-		//clear the elements we don't need:
-		glmat[3] = glmat[7] = glmat[11] = 0.0f;
-		glmat[15] = 1.0f;
-
-		glMultMatrixf(&(glmat[0]));
-
-		glRotatef(90,0,1,0);
-		glTranslatef(0,0,-r/2);
-		glScalef(r, r, r);
-		RenderCylinder();
-
-	    glPopMatrix();
+		//NxWheelShape has no width, draw it as wide as its radius
+		DrawWheel(wheelData->pose, r, r, wheelData->rollAngle);
 	}
 }
 
@@ -1039,6 +1087,83 @@ void DrawShape(NxShape* shape, bool useShapeUserData)
 	}
 }
 
+void DrawShape(NxShape* shape, const NxMat34& pose, bool useShapeUserData)
+{
+	glEnable(GL_NORMALIZE);
+
+    switch(shape->getType())
+    {
+		case NX_SHAPE_PLANE:
+			DrawPlane(shape, pose);
+		break;
+		case NX_SHAPE_BOX:
+			DrawBox(shape, pose);
+		break;
+		case NX_SHAPE_SPHERE:
+			DrawSphere(shape, pose);
+		break;
+		case NX_SHAPE_CAPSULE:
+			DrawCapsule(shape, pose);
+		break;
+		case NX_SHAPE_CONVEX:
+			DrawConvex(shape, pose, useShapeUserData);
+		break;
+		case NX_SHAPE_MESH:
+			DrawMesh(shape, pose, useShapeUserData);
+		break;
+		case NX_SHAPE_WHEEL:
+			//drawn at the pose saved by the wheel update
+			DrawWheelShape(shape);
+		break;
+		case NX_SHAPE_HEIGHTFIELD:
+			DrawHeightfield(shape);
+		break;
+	}
+}
+
+// Draw a shape from a copy of its pose, size and saved mesh data, without the shape itself
+void DrawShape(NxShapeType type, const NxMat34& pose, const NxVec3& dimensions, const void* meshData)
+{
+	glEnable(GL_NORMALIZE);
+
+	switch(type)
+	{
+		case NX_SHAPE_PLANE:
+			DrawPlane(pose);
+		break;
+		case NX_SHAPE_BOX:
+			DrawBox(pose, dimensions);
+		break;
+		case NX_SHAPE_SPHERE:
+			DrawSphere(pose, dimensions.x);
+		break;
+		case NX_SHAPE_CAPSULE:
+			DrawCapsule(pose, dimensions.x, dimensions.y);
+		break;
+		case NX_SHAPE_CONVEX:
+			if (meshData)
+			{
+				const NxConvexMeshDesc& desc = *(const NxConvexMeshDesc*)meshData;
+				DrawTriangleList(pose, desc.numTriangles, desc.triangles, desc.points);
+			}
+		break;
+		case NX_SHAPE_MESH:
+			if (meshData)
+			{
+				const NxTriangleMeshDesc& desc = *(const NxTriangleMeshDesc*)meshData;
+				DrawTriangleList(pose, desc.numTriangles, desc.triangles, desc.points);
+			}
+		break;
+		case NX_SHAPE_WHEEL:
+			DrawWheel(pose, dimensions.x, dimensions.y, dimensions.z);
+		break;
+		case NX_SHAPE_HEIGHTFIELD:
+			if (meshData)
+				DrawHeightFieldData(pose, *(const HeightFieldData*)meshData);
+		break;
+	}
+}
+
 void DrawActor(NxActor* actor, NxActor* selectedActor, bool useShapeUserData)
 {
 	// We render some actors using light source 1 instead of light source 0
@@ -1075,7 +1200,31 @@ void DrawActor(NxActor* actor, NxActor* selectedActor, bool useShapeUserData)
 	}
 }
 
-static void DrawActorShadow(NxActor* actor, const float* ShadowMat, bool useShapeUserData)
+void DrawActor(NxActor* actor, const NxMat34& actorPose, bool useShapeUserData)
+{
+	// We render some actors using light source 1 instead of light source 0
+	ActorUserData* ud = (ActorUserData*)(actor->userData);
+	if (ud && (ud->flags & UD_RENDER_USING_LIGHT1))
+	{
+		glDisable(GL_LIGHT0);
+		glEnable(GL_LIGHT1);
+	}
+
+	NxShape*const* shapes = actor->getShapes();
+	NxU32 nShapes = actor->getNbShapes();
+	while (nShapes--)
+	{
+		DrawShape(shapes[nShapes], actorPose*shapes[nShapes]->getLocalPose(), useShapeUserData);
+	}
+
+	if (ud && (ud->flags & UD_RENDER_USING_LIGHT1))
+	{
+		glDisable(GL_LIGHT1);
+		glEnable(GL_LIGHT0);
+	}
+}
+
+static void DrawActorShadow(NxActor* actor, const float* ShadowMat, const NxMat34* actorPose, bool useShapeUserData)
 {
 	glPushMatrix();
 	glMultMatrixf(ShadowMat);
@@ -1087,19 +1236,21 @@ static void DrawActorShadow(NxActor* actor, const float* ShadowMat, bool useShap
 	NxU32 nShapes = actor->getNbShapes();
 	while (nShapes--)
 	{
+		// use the given actor pose if any, the current one otherwise
+		NxMat34 pose = actorPose ? (*actorPose)*shapes[nShapes]->getLocalPose() : shapes[nShapes]->getGlobalPose();
 		switch(shapes[nShapes]->getType())
 		{
 		    case NX_SHAPE_BOX:
-			    DrawBox(shapes[nShapes]);
+			    DrawBox(shapes[nShapes], pose);
 			break;
 		    case NX_SHAPE_SPHERE:
-			    DrawSphere(shapes[nShapes]);
+			    DrawSphere(shapes[nShapes], pose);
 			break;
 		    case NX_SHAPE_CAPSULE:
-			    DrawCapsule(shapes[nShapes]);
+			    DrawCapsule(shapes[nShapes], pose);
 			break;
 		    case NX_SHAPE_CONVEX:
-			    DrawConvex(shapes[nShapes], useShapeUserData);
+			    DrawConvex(shapes[nShapes], pose, useShapeUserData);
 			break;		    
 		}
 	}	
@@ -1114,19 +1265,60 @@ static void DrawActorShadow(NxActor* actor, const float* ShadowMat, bool useShap
 void DrawActorShadow(NxActor* actor, bool useShapeUserData)
 {
 	const static float ShadowMat[]={ 1,0,0,0, 0,0,0,0, 0,0,1,0, 0,0,0,1 };
-	DrawActorShadow(actor, ShadowMat, useShapeUserData);
+	DrawActorShadow(actor, ShadowMat, 0, useShapeUserData);
+}
+
+void DrawActorShadow(NxActor* actor, const NxMat34& actorPose, bool useShapeUserData)
+{
+	const static float ShadowMat[]={ 1,0,0,0, 0,0,0,0, 0,0,1,0, 0,0,0,1 };
+	DrawActorShadow(actor, ShadowMat, &actorPose, useShapeUserData);
+}
+
+// Shadow of a shape drawn with DrawShape
+void DrawShapeShadow(NxShapeType type, const NxMat34& pose, const NxVec3& dimensions, const void* meshData)
+{
+	switch(type)
+	{
+		case NX_SHAPE_BOX:
+		case NX_SHAPE_SPHERE:
+		case NX_SHAPE_CAPSULE:
+		case NX_SHAPE_CONVEX:
+		case NX_SHAPE_WHEEL:
+		break;
+		case NX_SHAPE_PLANE:
+		case NX_SHAPE_HEIGHTFIELD:
+			//the ground, it receives the shadows
+			return;
+		default:
+			//triangle meshes are usually static level geometry, as in DrawActorShadow
+			return;
+	}
+
+	const static float ShadowMat[]={ 1,0,0,0, 0,0,0,0, 0,0,1,0, 0,0,0,1 };
+	glPushMatrix();
+	glMultMatrixf(ShadowMat);
+
+	glDisable(GL_LIGHTING);
+	glColor4f(0.05f, 0.1f, 0.15f, 1.0f);
+
+	DrawShape(type, pose, dimensions, meshData);
+
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+	glEnable(GL_LIGHTING);
+
+	glPopMatrix();
 }
 
 void DrawActorShadow2(NxActor* actor, bool useShapeUserData)
 {
     const static float ShadowMat[]={ 1,0,0,0, 1,0,-0.2,0, 0,0,1,0, 0,0,0,1 };
-	DrawActorShadow(actor, ShadowMat, useShapeUserData);
+	DrawActorShadow(actor, ShadowMat, 0, useShapeUserData);
 }
 
 void DrawActorShadowZUp(NxActor* actor, bool useShapeUserData)
 {
     const static float ShadowMat[]={ 1,0,0,0, 0,1,0,0, 0,0,0,0, 0,0,0,1 };
-	DrawActorShadow(actor, ShadowMat, useShapeUserData);
+	DrawActorShadow(actor, ShadowMat, 0, useShapeUserData);
 }
 
 void DrawCloth(NxCloth* cloth, bool shadows)
@@ -19,25 +19,31 @@ void DrawEllipse(NxU32 nbSegments, const NxMat34& matrix, const NxVec3& color, c
 
 void DrawWirePlane(NxShape* plane, const NxVec3& color);
 void DrawPlane(NxShape* plane);
+void DrawPlane(NxShape* plane, NxMat34 pose);
 
 void DrawWireBox(NxShape* box, const NxVec3& color, float lineWidth=2.0f);
 void DrawWireBox(const NxBox& obb, const NxVec3& color, float lineWidth=2.0f);
 void DrawBox(NxShape* box);
+void DrawBox(NxShape* box, const NxMat34& pose);
 
 void DrawWireSphere(NxShape* sphere, const NxVec3& color);
 void DrawWireSphere(NxSphere* sphere, const NxVec3& color);
 void DrawSphere(NxShape* sphere);
+void DrawSphere(NxShape* sphere, const NxMat34& pose);
 
 void DrawWireCapsule(NxShape* capsule, const NxVec3& color);
 void DrawWireCapsule(const NxCapsule& capsule, const NxVec3& color);
 void DrawCapsule(NxShape* capsule);
+void DrawCapsule(NxShape* capsule, const NxMat34& pose);
 void DrawCapsule(const NxVec3& color, NxF32 r, NxF32 h);
 
 void DrawWireConvex(NxShape* mesh, const NxVec3& color, bool useShapeUserData);
 void DrawConvex(NxShape* mesh, bool useShapeUserData);
+void DrawConvex(NxShape* mesh, const NxMat34& pose, bool useShapeUserData);
 
 void DrawWireMesh(NxShape* mesh, const NxVec3& color, bool useShapeUserData);
 void DrawMesh(NxShape* mesh, bool useShapeUserData);
+void DrawMesh(NxShape* mesh, const NxMat34& pose, bool useShapeUserData);
 void DrawWheelShape(NxShape* wheel);
 
 void DrawArrow(const NxVec3& posA, const NxVec3& posB, const NxVec3& color);
@@ -45,8 +51,13 @@ void DrawContactPoint(const NxVec3& pos, const NxReal radius, const NxVec3& colo
 
 void DrawWireShape(NxShape* shape, const NxVec3& color, bool useShapeUserData);
 void DrawShape(NxShape* shape, bool useShapeUserData);
+void DrawShape(NxShape* shape, const NxMat34& pose, bool useShapeUserData);
+void DrawShape(NxShapeType type, const NxMat34& pose, const NxVec3& dimensions, const void* meshData);
+void DrawShapeShadow(NxShapeType type, const NxMat34& pose, const NxVec3& dimensions, const void* meshData);
 void DrawActor(NxActor* actor, NxActor* selectedActor, bool useShapeUserData);
+void DrawActor(NxActor* actor, const NxMat34& actorPose, bool useShapeUserData);
 void DrawActorShadow(NxActor* actor, bool useShapeUserData);
+void DrawActorShadow(NxActor* actor, const NxMat34& actorPose, bool useShapeUserData);
 void DrawActorShadow2(NxActor* actor, bool useShapeUserData);
 void DrawActorShadowZUp(NxActor* actor, bool useShapeUserData);
 
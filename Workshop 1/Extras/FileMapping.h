@@ -0,0 +1,35 @@
+/// \file FileMapping.h
+///
+/// \brief Read-only memory mapped file.
+///
+
+#ifndef FILEMAPPING_H
+#define FILEMAPPING_H
+
+#include "Nx.h"
+
+class FileMapping
+{
+public:
+	FileMapping();
+	~FileMapping();
+
+	/// Map the whole file into memory. Returns false if the file can't be opened or is empty.
+	bool Open(const char* filename);
+	void Close();
+
+	bool IsOpen() const { return m_data != 0; }
+	const NxU8* GetData() const { return m_data; }
+	NxU32 GetSize() const { return m_size; }
+
+private:
+	FileMapping(const FileMapping&);
+	FileMapping& operator=(const FileMapping&);
+
+	const NxU8* m_data;
+	NxU32 m_size;
+	void* m_file;
+	void* m_mapping;
+};
+
+#endif // FILEMAPPING_H
@@ -0,0 +1,60 @@
+#define NOMINMAX
+#include <windows.h>
+#include "Nx.h"
+#include "FileMapping.h"
+
+FileMapping::FileMapping() : m_data(0), m_size(0), m_file(0), m_mapping(0)
+{
+}
+
+FileMapping::~FileMapping()
+{
+	Close();
+}
+
+bool FileMapping::Open(const char* filename)
+{
+	Close();
+
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 || size.HighPart != 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_file = file;
+	m_mapping = mapping;
+	m_data = (const NxU8*)view;
+	m_size = size.LowPart;
+	return true;
+}
+
+void FileMapping::Close()
+{
+	if (m_data) UnmapViewOfFile(m_data);
+	if (m_mapping) CloseHandle((HANDLE)m_mapping);
+	if (m_file) CloseHandle((HANDLE)m_file);
+	m_data = 0;
+	m_size = 0;
+	m_mapping = 0;
+	m_file = 0;
+}
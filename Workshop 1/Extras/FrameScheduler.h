@@ -0,0 +1,54 @@
+/// \file FrameScheduler.h
+///
+/// \brief Pace the redraws to a target frame rate and skip the ones that wouldn't change anything.
+///
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include "NxPhysics.h"
+
+///
+/// Frame pacing for the idle callback.
+///
+/// WaitForFrame sleeps until the next frame deadline and returns whether a redraw is due, i.e.
+/// Invalidate was called since the last one. Nothing new to draw costs one short wake-up per
+/// frame period instead of a busy loop. A missed deadline moves the next one a full period on
+/// instead of catching up with a burst of frames. The system timer resolution is raised to
+/// 1ms while the scheduler exists so the sleeps end close to the deadline.
+///
+class FrameScheduler
+{
+public:
+	FrameScheduler(NxReal framesPerSecond = 60.0f);
+	~FrameScheduler();
+
+	/// Frames per second, 0 draws as soon as something changed.
+	void SetTargetRate(NxReal framesPerSecond);
+	NxReal GetTargetRate() const { return m_rate; }
+
+	/// Something visible changed, draw the next frame.
+	void Invalidate() { m_dirty = true; }
+
+	/// Sleep until the next frame is due, returns true if it has to be drawn.
+	bool WaitForFrame();
+
+	/// Time between the last two calls of WaitForFrame, in seconds.
+	NxReal GetTickTime() const { return m_tickTime; }
+
+	NxU32 GetNbFrames() const { return m_nbFrames; }
+	NxU32 GetNbSkipped() const { return m_nbSkipped; }
+
+private:
+	NxReal m_rate;
+	NxF64 m_period;			//in counter ticks, 0 if unlimited
+	NxF64 m_frequency;
+	NxF64 m_deadline;
+	NxF64 m_lastTick;
+	NxReal m_tickTime;
+	bool m_dirty;
+	NxU32 m_nbFrames;
+	NxU32 m_nbSkipped;
+};
+
+#endif // FRAMESCHEDULER_H
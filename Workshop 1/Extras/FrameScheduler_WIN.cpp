@@ -0,0 +1,73 @@
+#define NOMINMAX
+#include <windows.h>
+#include "Nx.h"
+#include "FrameScheduler.h"
+
+static NxF64 GetCounter()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (NxF64)counter.QuadPart;
+}
+
+FrameScheduler::FrameScheduler(NxReal framesPerSecond) :
+	m_rate(0), m_period(0), m_tickTime(0), m_dirty(true), m_nbFrames(0), m_nbSkipped(0)
+{
+	timeBeginPeriod(1);
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	m_frequency = (NxF64)frequency.QuadPart;
+	m_lastTick = GetCounter();
+	m_deadline = m_lastTick;
+	SetTargetRate(framesPerSecond);
+}
+
+FrameScheduler::~FrameScheduler()
+{
+	timeEndPeriod(1);
+}
+
+void FrameScheduler::SetTargetRate(NxReal framesPerSecond)
+{
+	m_rate = framesPerSecond > 0 ? framesPerSecond : 0;
+	m_period = m_rate > 0 ? m_frequency/m_rate : 0;
+	m_deadline = GetCounter() + m_period;
+}
+
+bool FrameScheduler::WaitForFrame()
+{
+	NxF64 now = GetCounter();
+	if (m_period > 0)
+	{
+		//sleep the whole milliseconds, yield for the rest
+		while (now < m_deadline)
+		{
+			DWORD milliseconds = (DWORD)((m_deadline - now)*1000.0/m_frequency);
+			Sleep(milliseconds);
+			now = GetCounter();
+		}
+
+		m_deadline += m_period;
+		if (m_deadline < now)
+			m_deadline = now + m_period;
+	}
+	else if (!m_dirty)
+	{
+		//unlimited, but don't spin while there is nothing to draw
+		Sleep(1);
+		now = GetCounter();
+	}
+
+	m_tickTime = (NxReal)((now - m_lastTick)/m_frequency);
+	m_lastTick = now;
+
+	if (!m_dirty)
+	{
+		m_nbSkipped++;
+		return false;
+	}
+	m_dirty = false;
+	m_nbFrames++;
+	return true;
+}
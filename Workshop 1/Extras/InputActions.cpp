@@ -0,0 +1,133 @@
+#include <string.h>
+#include "NxPhysics.h"
+#include "InputActions.h"
+
+InputActions::InputActions() : m_active(0), m_boundActions(0)
+{
+	memset(m_keys, NO_INPUT_ACTION, sizeof(m_keys));
+	memset(m_held, 0, sizeof(m_held));
+	memset(m_nbHeld, 0, sizeof(m_nbHeld));
+	for (NxU32 i = 0; i < MAX_INPUT_ACTIONS; i++)
+		m_axes[i].zero();
+}
+
+void InputActions::Bind(unsigned char key, NxU32 action, const NxVec3& axis)
+{
+	NX_ASSERT(action < MAX_INPUT_ACTIONS);
+
+	//a held key moves over to its new action
+	bool held = m_held[key];
+	Release(key);
+	m_keys[key] = (NxU8)action;
+	m_axes[action] = axis;
+	if (held) Press(key);
+}
+
+void InputActions::Unbind(unsigned char key)
+{
+	Release(key);
+	m_keys[key] = NO_INPUT_ACTION;
+}
+
+bool InputActions::KeyDown(unsigned char key)
+{
+	if (m_keys[key] == NO_INPUT_ACTION) return false;
+	Press(key);
+	return true;
+}
+
+bool InputActions::KeyUp(unsigned char key)
+{
+	if (m_keys[key] == NO_INPUT_ACTION) return false;
+	Release(key);
+	return true;
+}
+
+void InputActions::ReleaseAll()
+{
+	memset(m_held, 0, sizeof(m_held));
+	memset(m_nbHeld, 0, sizeof(m_nbHeld));
+	m_active = 0;
+}
+
+void InputActions::Press(unsigned char key)
+{
+	//repeated key downs count once
+	if (m_held[key] || m_keys[key] == NO_INPUT_ACTION) return;
+	m_held[key] = true;
+	m_nbHeld[m_keys[key]]++;
+	m_active |= 1u << m_keys[key];
+}
+
+void InputActions::Release(unsigned char key)
+{
+	if (!m_held[key]) return;
+	m_held[key] = false;
+	if (!--m_nbHeld[m_keys[key]])
+		m_active &= ~(1u << m_keys[key]);
+}
+
+NxVec3 InputActions::GetAxis(NxU32 actionMask) const
+{
+	NxVec3 axis(0,0,0);
+	//visit the set bits only, clearing the lowest one each time
+	for (NxU32 bits = m_active & actionMask; bits; bits &= bits - 1)
+	{
+		NxU32 action = 0;
+		while (!(bits & (1u << action))) action++;
+		axis += m_axes[action];
+	}
+	return axis;
+}
+
+void InputActions::BindActor(ActorHandle actor, NxU32 actionMask)
+{
+	UnbindActor(actor);
+	if (!actor.IsValid() || !actionMask) return;
+
+	ActorBinding binding;
+	binding.actor = actor;
+	binding.actions = actionMask;
+	m_bindings.pushBack(binding);
+	m_boundActions |= actionMask;
+}
+
+void InputActions::UnbindActor(ActorHandle actor)
+{
+	for (NxU32 i = 0; i < m_bindings.size(); i++)
+	{
+		if (m_bindings[i].actor != actor) continue;
+		m_bindings.replaceWithLast(i);
+		return;
+	}
+}
+
+bool InputActions::IsActorBound(ActorHandle actor) const
+{
+	for (NxU32 i = 0; i < m_bindings.size(); i++)
+		if (m_bindings[i].actor == actor) return true;
+	return false;
+}
+
+void InputActions::ApplyForces(const ActorHandleTable& handles, NxReal scale)
+{
+	if (!(m_active & m_boundActions)) return;
+
+	NxU32 boundActions = 0;
+	for (NxU32 i = 0; i < m_bindings.size(); )
+	{
+		NxActor* actor = handles.Get(m_bindings[i].actor);
+		if (!actor)
+		{
+			m_bindings.replaceWithLast(i);
+			continue;
+		}
+
+		NxVec3 force = GetAxis(m_bindings[i].actions);
+		if (!force.isZero())
+			actor->addForce(force*scale);
+		boundActions |= m_bindings[i].actions;
+		i++;
+	}
+	m_boundActions = boundActions;
+}
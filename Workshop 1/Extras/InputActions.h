@@ -0,0 +1,75 @@
+/// \file InputActions.h
+///
+/// \brief Key to action mapping with a bitset of the held actions.
+///
+
+#ifndef INPUTACTIONS_H
+#define INPUTACTIONS_H
+
+#include "NxPhysics.h"
+#include "ActorHandles.h"
+
+static const NxU32 MAX_INPUT_ACTIONS = 32;
+static const NxU8 NO_INPUT_ACTION = 0xff;
+
+///
+/// Maps keys to up to 32 actions and keeps the held ones in a single bitset.
+///
+/// Key events only set or clear a bit, so per frame work is limited to the held actions and
+/// nothing is done when no action is held. An action stays held until the last of its held keys
+/// is released. Each action has an axis; GetAxis sums the axes of
+/// the held actions in a mask, which turns e.g. the six movement keys into one direction.
+/// Actors bound to a set of actions get the summed axis of those actions as a force in
+/// ApplyForces; bindings to removed actors are dropped there.
+///
+class InputActions
+{
+public:
+	InputActions();
+
+	/// Bind a key to an action, a key triggers one action and an action can have several keys.
+	void Bind(unsigned char key, NxU32 action, const NxVec3& axis = NxVec3(0,0,0));
+	void Unbind(unsigned char key);
+
+	/// Returns true if the key is bound to an action.
+	bool KeyDown(unsigned char key);
+	bool KeyUp(unsigned char key);
+
+	/// Release all actions, e.g. when the window loses focus.
+	void ReleaseAll();
+
+	NxU32 GetActive() const { return m_active; }
+	bool IsActive(NxU32 action) const { return (m_active & (1u << action)) != 0; }
+
+	/// Sum of the axes of the held actions in the mask.
+	NxVec3 GetAxis(NxU32 actionMask) const;
+
+	/// Push an actor along the axes of the held actions in the mask, replaces an earlier binding.
+	void BindActor(ActorHandle actor, NxU32 actionMask);
+	void UnbindActor(ActorHandle actor);
+	bool IsActorBound(ActorHandle actor) const;
+	NxU32 GetNbBoundActors() const { return m_bindings.size(); }
+
+	/// Add the axis of the held actions times scale as a force to every bound actor.
+	void ApplyForces(const ActorHandleTable& handles, NxReal scale);
+
+private:
+	void Press(unsigned char key);
+	void Release(unsigned char key);
+
+	struct ActorBinding
+	{
+		ActorHandle actor;
+		NxU32 actions;
+	};
+
+	NxU8 m_keys[256];				//action of each key, NO_INPUT_ACTION if unbound
+	bool m_held[256];				//bound keys that are down
+	NxU8 m_nbHeld[MAX_INPUT_ACTIONS];	//held keys of each action
+	NxVec3 m_axes[MAX_INPUT_ACTIONS];
+	NxU32 m_active;
+	NxU32 m_boundActions;			//union of the actions of all bindings
+	NxArray<ActorBinding> m_bindings;
+};
+
+#endif // INPUTACTIONS_H
@@ -0,0 +1,128 @@
+#include "NxPhysics.h"
+#include "MeshRegistry.h"
+
+static const NxU32 INITIAL_TABLE_SIZE = 64;
+
+MeshRegistry::MeshRegistry() : m_nbMeshes(0), m_nbReferences(0), m_records(64), m_convexDescs(64), m_triangleMeshDescs(64)
+{
+}
+
+NxU32 MeshRegistry::GetHome(const void* mesh) const
+{
+	//meshes are heap allocated, the low bits carry no information
+	size_t key = (size_t)mesh >> 4;
+	return ((NxU32)key*2654435761u) & (m_table.size() - 1);
+}
+
+NxU32 MeshRegistry::FindSlot(const void* mesh) const
+{
+	NxU32 mask = m_table.size() - 1;
+	NxU32 slot = GetHome(mesh);
+	while (m_table[slot] && m_table[slot]->mesh != mesh)
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+MeshRecord* MeshRegistry::Find(const void* mesh) const
+{
+	if (!m_table.size()) return 0;
+	return m_table[FindSlot(mesh)];
+}
+
+MeshRecord* MeshRegistry::Acquire(NxShape& shape)
+{
+	void* mesh;
+	if (shape.getType() == NX_SHAPE_CONVEX)
+		mesh = &shape.isConvexMesh()->getConvexMesh();
+	else if (shape.getType() == NX_SHAPE_MESH)
+		mesh = &shape.isTriangleMesh()->getTriangleMesh();
+	else
+		return 0;
+
+	if (2*(m_nbMeshes + 1) > m_table.size())
+		Grow();
+
+	NxU32 slot = FindSlot(mesh);
+	MeshRecord* record = m_table[slot];
+	if (!record)
+	{
+		record = m_records.Allocate();
+		record->mesh = mesh;
+		record->type = shape.getType();
+		record->renderBuffer = 0;
+		record->refCount = 0;
+		if (record->type == NX_SHAPE_CONVEX)
+		{
+			NxConvexMeshDesc* desc = m_convexDescs.Allocate();
+			((NxConvexMesh*)mesh)->saveToDesc(*desc);
+			record->desc = desc;
+		}
+		else
+		{
+			NxTriangleMeshDesc* desc = m_triangleMeshDescs.Allocate();
+			((NxTriangleMesh*)mesh)->saveToDesc(*desc);
+			record->desc = desc;
+		}
+		m_table[slot] = record;
+		m_nbMeshes++;
+	}
+
+	record->refCount++;
+	m_nbReferences++;
+	return record;
+}
+
+void MeshRegistry::Release(MeshRecord* record)
+{
+	if (!record) return;
+	m_nbReferences--;
+	if (--record->refCount) return;
+
+	//remove the record and shift back the entries that probed past it
+	NxU32 mask = m_table.size() - 1;
+	NxU32 hole = FindSlot(record->mesh);
+	m_table[hole] = 0;
+	for (NxU32 slot = (hole + 1) & mask; m_table[slot]; slot = (slot + 1) & mask)
+	{
+		NxU32 home = GetHome(m_table[slot]->mesh);
+		bool movable = hole < slot ? (home <= hole || home > slot) : (home <= hole && home > slot);
+		if (movable)
+		{
+			m_table[hole] = m_table[slot];
+			m_table[slot] = 0;
+			hole = slot;
+		}
+	}
+	m_nbMeshes--;
+
+	if (record->type == NX_SHAPE_CONVEX)
+		m_convexDescs.Release((NxConvexMeshDesc*)record->desc);
+	else
+		m_triangleMeshDescs.Release((NxTriangleMeshDesc*)record->desc);
+	m_records.Release(record);
+}
+
+void MeshRegistry::Reset()
+{
+	for (NxU32 i = 0; i < m_table.size(); i++)
+		m_table[i] = 0;
+	m_nbMeshes = 0;
+	m_nbReferences = 0;
+	m_records.Reset();
+	m_convexDescs.Reset();
+	m_triangleMeshDescs.Reset();
+}
+
+void MeshRegistry::Grow()
+{
+	NxArray<MeshRecord*> old;
+	old.resize(m_table.size());
+	for (NxU32 i = 0; i < m_table.size(); i++)
+		old[i] = m_table[i];
+
+	NxU32 size = m_table.size() ? 2*m_table.size() : INITIAL_TABLE_SIZE;
+	m_table.clear();
+	m_table.resize(size, 0);
+	for (NxU32 i = 0; i < old.size(); i++)
+		if (old[i]) m_table[FindSlot(old[i]->mesh)] = old[i];
+}
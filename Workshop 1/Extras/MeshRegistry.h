@@ -0,0 +1,68 @@
+/// \file MeshRegistry.h
+///
+/// \brief Shared, reference counted mesh descriptors for the shapes using the same mesh.
+///
+
+#ifndef MESHREGISTRY_H
+#define MESHREGISTRY_H
+
+#include "NxPhysics.h"
+#include "Pool.h"
+
+///
+/// Data kept once per unique convex or triangle mesh.
+///
+struct MeshRecord
+{
+	void* mesh;				//NxConvexMesh or NxTriangleMesh, the key of the record
+	NxShapeType type;		//NX_SHAPE_CONVEX or NX_SHAPE_MESH
+	void* desc;				//NxConvexMeshDesc or NxTriangleMeshDesc saved from the mesh
+	void* renderBuffer;		//reserved for render data built from desc, owned by the renderer
+	NxU32 refCount;
+};
+
+///
+/// Maps a mesh to its record, an open addressing table keyed by the mesh pointer.
+///
+/// Acquiring the mesh of a shape saves the descriptor the first time only, later shapes with
+/// the same mesh share the record; the record is freed when its last shape releases it.
+///
+class MeshRegistry
+{
+public:
+	MeshRegistry();
+
+	/// Record of the convex or triangle mesh of a shape, 0 for other shape types.
+	MeshRecord* Acquire(NxShape& shape);
+	void Release(MeshRecord* record);
+
+	/// Record of a mesh if any shape uses it.
+	MeshRecord* Find(const void* mesh) const;
+
+	/// Drop all records at once, e.g. before the scene is released.
+	void Reset();
+
+	NxU32 GetNbMeshes() const { return m_nbMeshes; }
+	NxU32 GetNbReferences() const { return m_nbReferences; }
+
+	const PoolStats& GetConvexDescStats() const { return m_convexDescs.GetStats(); }
+	const PoolStats& GetTriangleMeshDescStats() const { return m_triangleMeshDescs.GetStats(); }
+
+private:
+	MeshRegistry(const MeshRegistry&);
+	MeshRegistry& operator=(const MeshRegistry&);
+
+	NxU32 GetHome(const void* mesh) const;
+	NxU32 FindSlot(const void* mesh) const;
+	void Grow();
+
+	NxArray<MeshRecord*> m_table;	//power of two size, at most half full
+	NxU32 m_nbMeshes;
+	NxU32 m_nbReferences;
+
+	Pool<MeshRecord> m_records;
+	Pool<NxConvexMeshDesc> m_convexDescs;
+	Pool<NxTriangleMeshDesc> m_triangleMeshDescs;
+};
+
+#endif // MESHREGISTRY_H
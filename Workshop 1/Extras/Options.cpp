@@ -0,0 +1,164 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "NxPhysics.h"
+#include "Options.h"
+
+static const NxReal DEFAULT_HEADLESS_TIME = 10.0f;	//seconds a headless run lasts without --benchmark
+static const char* gRenderModes[] = { "solid", "wireframe", "both" };	//same order as RenderingMode
+
+Options::Options() :
+	windowWidth(512), windowHeight(512), headless(false), renderMode(0), shadows(true), frameRate(60.0f),
+	sceneFile(NULL), nbActors(1),
+	timeStep(1.0f/60.0f), nbSubsteps(1), nbThreads(0), nbBackgroundThreads(0),
+	benchmarkTime(0), traceFile(NULL), traceBinary(false),
+	showHelp(false)
+{
+}
+
+static bool ParseUInt(const char* text, NxU32 minValue, NxU32& value)
+{
+	char* end;
+	unsigned long v = strtoul(text, &end, 10);
+	if (end == text || *end || text[0] == '-' || v < minValue || v > 0xffffffffUL) return false;
+	value = (NxU32)v;
+	return true;
+}
+
+static bool ParseReal(const char* text, NxReal minValue, NxReal& value)
+{
+	char* end;
+	double v = strtod(text, &end);
+	if (end == text || *end || v < minValue || v > 1e9) return false;
+	value = (NxReal)v;
+	return true;
+}
+
+static bool ParseSize(const char* text, NxU32& width, NxU32& height)
+{
+	unsigned int w, h;
+	char tail;
+	if (sscanf(text, "%ux%u%c", &w, &h, &tail) != 2 || !w || !h || w > 16384 || h > 16384) return false;
+	width = w;
+	height = h;
+	return true;
+}
+
+static bool ParseRenderMode(const char* text, NxU32& mode)
+{
+	for (NxU32 i = 0; i < sizeof(gRenderModes)/sizeof(gRenderModes[0]); i++)
+	{
+		if (strcmp(text, gRenderModes[i]) == 0)
+		{
+			mode = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ParseOptions(int& argc, char** argv, Options& options)
+{
+	int nbKept = 1;
+	for (int i = 1; i < argc; i++)
+	{
+		char* arg = argv[i];
+		if (strncmp(arg, "--", 2) != 0)
+		{
+			argv[nbKept++] = arg;
+			continue;
+		}
+
+		//the value is either after '=' or the next argument
+		char name[64];
+		const char* value = strchr(arg, '=');
+		size_t length = value ? (size_t)(value - arg) : strlen(arg);
+		if (length >= sizeof(name)) length = sizeof(name) - 1;
+		memcpy(name, arg + 2, length - 2);
+		name[length - 2] = 0;
+		if (value) value++;
+
+		//switches
+		bool isSwitch = true;
+		if (strcmp(name, "help") == 0) options.showHelp = true;
+		else if (strcmp(name, "headless") == 0) options.headless = true;
+		else if (strcmp(name, "no-shadows") == 0) options.shadows = false;
+		else isSwitch = false;
+		if (isSwitch)
+		{
+			if (value)
+			{
+				printf("Option --%s takes no value.\n", name);
+				return false;
+			}
+			continue;
+		}
+
+		if (!value)
+		{
+			if (i + 1 >= argc)
+			{
+				printf("Option --%s needs a value.\n", name);
+				return false;
+			}
+			value = argv[++i];
+		}
+
+		bool valid = true;
+		if (strcmp(name, "window") == 0) valid = ParseSize(value, options.windowWidth, options.windowHeight);
+		else if (strcmp(name, "render") == 0) valid = ParseRenderMode(value, options.renderMode);
+		else if (strcmp(name, "fps") == 0) valid = ParseReal(value, 0, options.frameRate);
+		else if (strcmp(name, "scene") == 0) options.sceneFile = value;
+		else if (strcmp(name, "actors") == 0) valid = ParseUInt(value, 0, options.nbActors);
+		else if (strcmp(name, "dt") == 0) valid = ParseReal(value, 0.0001f, options.timeStep);
+		else if (strcmp(name, "substeps") == 0) valid = ParseUInt(value, 1, options.nbSubsteps);
+		else if (strcmp(name, "threads") == 0) valid = ParseUInt(value, 0, options.nbThreads);
+		else if (strcmp(name, "background-threads") == 0) valid = ParseUInt(value, 0, options.nbBackgroundThreads);
+		else if (strcmp(name, "benchmark") == 0) valid = ParseReal(value, 0, options.benchmarkTime);
+		else if (strcmp(name, "trace") == 0) options.traceFile = value;
+		else if (strcmp(name, "trace-binary") == 0)
+		{
+			options.traceFile = value;
+			options.traceBinary = true;
+		}
+		else
+		{
+			printf("Unknown option --%s.\n", name);
+			return false;
+		}
+
+		if (!valid)
+		{
+			printf("Bad value '%s' for option --%s.\n", value, name);
+			return false;
+		}
+	}
+	argv[nbKept] = NULL;
+	argc = nbKept;
+
+	//a headless run has no window to close
+	if (options.headless && options.benchmarkTime <= 0)
+		options.benchmarkTime = DEFAULT_HEADLESS_TIME;
+	return true;
+}
+
+void PrintUsage(const char* program)
+{
+	printf("\nUsage: %s [options]\n", program);
+	printf(" --window WxH             window size, default 512x512\n");
+	printf(" --headless               no window, step as fast as possible and report\n");
+	printf(" --render MODE            solid, wireframe or both\n");
+	printf(" --no-shadows             start with the shadows off\n");
+	printf(" --fps N                  redraws per second, 0 = as soon as something changed\n");
+	printf(" --scene FILE             load a state saved with F5, needs the same actors\n");
+	printf(" --actors N               number of boxes, default 1\n");
+	printf(" --dt SECONDS             fixed time step, default 1/60\n");
+	printf(" --substeps N             SDK substeps per time step, default 1\n");
+	printf(" --threads N              SDK worker threads, default 0\n");
+	printf(" --background-threads N   SDK background threads, default 0\n");
+	printf(" --benchmark SECONDS      run, report the step and frame rates and exit\n");
+	printf(" --trace FILE             write a Chrome trace of the phases\n");
+	printf(" --trace-binary FILE      write a binary trace of the phases\n");
+	printf(" --help                   show this list\n");
+}
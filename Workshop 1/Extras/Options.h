@@ -0,0 +1,54 @@
+/// \file Options.h
+///
+/// \brief Command line options: window, scene contents, stepping, threads, benchmark and trace output.
+///
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "NxPhysics.h"
+
+///
+/// Settings taken from the command line, the defaults match the program without options.
+///
+struct Options
+{
+	Options();
+
+	//window
+	NxU32 windowWidth;
+	NxU32 windowHeight;
+	bool headless;				//no window, step as fast as possible for the benchmark time
+	NxU32 renderMode;			//index into RenderingMode: solid, wireframe, both
+	bool shadows;
+	NxReal frameRate;			//redraws per second, 0 draws as soon as something changed
+
+	//scene
+	const char* sceneFile;		//state saved with F5, loaded after the scene is built
+	NxU32 nbActors;				//number of boxes
+
+	//stepping
+	NxReal timeStep;
+	NxU32 nbSubsteps;			//equal SDK substeps per step
+	NxU32 nbThreads;			//SDK worker threads per step, 0 runs the step on one thread
+	NxU32 nbBackgroundThreads;	//SDK background threads, 0 is the SDK default
+
+	//measurement
+	NxReal benchmarkTime;		//seconds to run before reporting and exiting, 0 runs until closed
+	const char* traceFile;
+	bool traceBinary;
+
+	bool showHelp;
+};
+
+///
+/// Read the options of the form --name value or --name=value and remove them from argv.
+/// Other arguments are left in place for glutInit. Prints the problem and returns false on an
+/// unknown option or a bad value.
+///
+bool ParseOptions(int& argc, char** argv, Options& options);
+
+/// Print the list of options.
+void PrintUsage(const char* program);
+
+#endif // OPTIONS_H
@@ -0,0 +1,151 @@
+#include <string.h>
+#include "PerfHUD.h"
+#include "Thread.h"
+
+static const char* gPhaseNames[NB_PERF_PHASES] = { "fetch", "update", "forces", "simulate", "capture", "keys", "draw", "swap" };
+static const NxReal AVERAGE_WEIGHT = 0.05f;		//weight of a new sample in the running average
+static const NxReal LINE_SPACING = 0.03f;
+
+//frame time graph, in normalised screen coordinates
+static const NxReal GRAPH_LEFT = 0.02f;
+static const NxReal GRAPH_BOTTOM = 0.02f;
+static const NxReal GRAPH_WIDTH = 0.4f;
+static const NxReal GRAPH_HEIGHT = 0.15f;
+static const NxReal GRAPH_RANGE = 1.0f/20.0f;	//frame time at the top of the graph
+
+const char* GetPerfPhaseName(PerfPhase phase)
+{
+	return gPhaseNames[phase];
+}
+
+PerfHUD::PerfHUD() : m_nextFrame(0), m_firstSlot(0), m_nbSlots(0), m_visible(false)
+{
+	memset(m_stats, 0, sizeof(m_stats));
+	memset((void*)m_averageUs, 0, sizeof(m_averageUs));
+	memset((void*)m_maxUs, 0, sizeof(m_maxUs));
+	memset((void*)m_counts, 0, sizeof(m_counts));
+	memset(m_frames, 0, sizeof(m_frames));
+}
+
+void PerfHUD::Init(HUD& hud, NxReal x, NxReal y)
+{
+	//frame line, one line per phase and the counts
+	m_firstSlot = hud.m_DisplayString.size();
+	m_nbSlots = NB_PERF_PHASES + 2;
+	for (NxU32 i = 0; i < m_nbSlots; i++)
+		hud.AddDisplayString("", x, y - i*LINE_SPACING);
+}
+
+void PerfHUD::SetVisible(HUD& hud, bool visible)
+{
+	m_visible = visible;
+	if (visible) return;
+
+	for (NxU32 i = 0; i < m_nbSlots; i++)
+		hud.m_DisplayString[m_firstSlot + i].m_string[0] = '\0';
+}
+
+void PerfHUD::Record(PerfPhase phase, NxReal seconds)
+{
+	PhaseStats& stats = m_stats[phase];
+	stats.average += (seconds - stats.average)*AVERAGE_WEIGHT;
+
+	//maximum of the current second
+	double now = getPreciseTime();
+	if (now - stats.maxStart > 1.0)
+	{
+		stats.maxStart = now;
+		stats.max = seconds;
+	}
+	else if (seconds > stats.max)
+		stats.max = seconds;
+
+	AtomicStore(&m_averageUs[phase], (NxU32)(stats.average*1000000.0f));
+	AtomicStore(&m_maxUs[phase], (NxU32)(stats.max*1000000.0f));
+}
+
+void PerfHUD::SetCount(PerfCount count, NxU32 value)
+{
+	AtomicStore(&m_counts[count], value);
+}
+
+void PerfHUD::AddFrame(NxReal seconds)
+{
+	m_frames[m_nextFrame] = seconds;
+	m_nextFrame = (m_nextFrame + 1) % PERF_GRAPH_SIZE;
+}
+
+void PerfHUD::Update(HUD& hud)
+{
+	if (!m_visible || !m_nbSlots) return;
+	DisplayString* lines = &hud.m_DisplayString[m_firstSlot];
+
+	NxReal total = 0, max = 0;
+	for (NxU32 i = 0; i < PERF_GRAPH_SIZE; i++)
+	{
+		total += m_frames[i];
+		if (m_frames[i] > max) max = m_frames[i];
+	}
+	NxReal average = total/PERF_GRAPH_SIZE;
+	sprintf(lines[0].m_string, "frame    %6.2f ms  max %6.2f  %5.1f fps", average*1000.0f, max*1000.0f, average > 0 ? 1.0f/average : 0.0f);
+
+	for (NxU32 i = 0; i < NB_PERF_PHASES; i++)
+	{
+		sprintf(lines[1 + i].m_string, "%-8s %6.2f ms  max %6.2f", gPhaseNames[i],
+			AtomicLoad(&m_averageUs[i])*0.001f, AtomicLoad(&m_maxUs[i])*0.001f);
+	}
+
+	sprintf(lines[1 + NB_PERF_PHASES].m_string, "actors %u  awake %u  contacts %u",
+		AtomicLoad(&m_counts[PERF_ACTORS]), AtomicLoad(&m_counts[PERF_AWAKE]), AtomicLoad(&m_counts[PERF_CONTACTS]));
+}
+
+void PerfHUD::RenderGraph() const
+{
+	if (!m_visible) return;
+
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	gluOrtho2D(0, 1, 0, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+
+	glBegin(GL_LINES);
+	//one bar per frame, oldest on the left; green up to 60Hz, yellow up to 30Hz, red above
+	NxReal step = GRAPH_WIDTH/PERF_GRAPH_SIZE;
+	for (NxU32 i = 0; i < PERF_GRAPH_SIZE; i++)
+	{
+		NxReal frameTime = m_frames[(m_nextFrame + i) % PERF_GRAPH_SIZE];
+		NxReal height = frameTime < GRAPH_RANGE ? frameTime/GRAPH_RANGE : 1.0f;
+		if (frameTime <= 1.0f/60.0f)
+			glColor3f(0.0f, 0.8f, 0.0f);
+		else if (frameTime <= 1.0f/30.0f)
+			glColor3f(0.8f, 0.8f, 0.0f);
+		else
+			glColor3f(0.8f, 0.0f, 0.0f);
+		NxReal x = GRAPH_LEFT + (i + 0.5f)*step;
+		glVertex2f(x, GRAPH_BOTTOM);
+		glVertex2f(x, GRAPH_BOTTOM + height*GRAPH_HEIGHT);
+	}
+
+	//60Hz and 30Hz marks
+	glColor3f(0.5f, 0.5f, 0.5f);
+	for (NxU32 i = 1; i <= 2; i++)
+	{
+		NxReal y = GRAPH_BOTTOM + GRAPH_HEIGHT*(i/60.0f)/GRAPH_RANGE;
+		glVertex2f(GRAPH_LEFT, y);
+		glVertex2f(GRAPH_LEFT + GRAPH_WIDTH, y);
+	}
+	glEnd();
+
+	glPopAttrib();
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+}
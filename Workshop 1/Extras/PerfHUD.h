@@ -0,0 +1,109 @@
+/// \file PerfHUD.h
+///
+/// \brief Performance overlay: per phase timings, scene counts and a rolling frame time graph.
+///
+
+#ifndef PERFHUD_H
+#define PERFHUD_H
+
+#include "NxPhysics.h"
+#include "HUD.h"
+#include "Timing.h"
+
+/// Timed parts of a frame, the first ones run on the simulation thread.
+enum PerfPhase
+{
+	PERF_FETCH,			//waiting in fetchResults
+	PERF_UPDATE,		//UpdateScene
+	PERF_FORCES,		//forces of the held keys
+	PERF_SIMULATE,		//submitting the next step
+	PERF_CAPTURE,		//copying the poses for the renderer
+	PERF_KEYS,			//KeyHold
+	PERF_DRAW,			//everything drawn before the swap
+	PERF_SWAP,			//flush and swap
+	NB_PERF_PHASES
+};
+
+enum PerfCount
+{
+	PERF_ACTORS,
+	PERF_AWAKE,
+	PERF_CONTACTS,
+	NB_PERF_COUNTS
+};
+
+static const NxU32 PERF_GRAPH_SIZE = 128;
+
+/// Short name of a phase, a string literal.
+const char* GetPerfPhaseName(PerfPhase phase);
+
+///
+/// Shows the phase timings, counts and frame times in display strings of a HUD.
+///
+/// Every phase has one writer thread which keeps a running average and the maximum of the current
+/// second privately and publishes them as whole microseconds, so recording and displaying need
+/// no lock. Update formats into the DisplayStrings added by Init, nothing is allocated per frame.
+///
+class PerfHUD
+{
+public:
+	PerfHUD();
+
+	/// Add the display strings at x, y and below, they are empty while the overlay is hidden.
+	void Init(HUD& hud, NxReal x, NxReal y);
+
+	void SetVisible(HUD& hud, bool visible);
+	bool IsVisible() const { return m_visible; }
+
+	/// Add a measured duration, each phase must always be recorded from the same thread.
+	void Record(PerfPhase phase, NxReal seconds);
+	void SetCount(PerfCount count, NxU32 value);
+
+	/// Add the time since the last drawn frame to the graph.
+	void AddFrame(NxReal seconds);
+
+	/// Write the current values into the display strings.
+	void Update(HUD& hud);
+
+	/// Draw the frame time graph over the scene.
+	void RenderGraph() const;
+
+private:
+	struct PhaseStats
+	{
+		NxReal average;
+		NxReal max;
+		double maxStart;	//time the current second began
+	};
+
+	PhaseStats m_stats[NB_PERF_PHASES];		//writer side
+	volatile NxU32 m_averageUs[NB_PERF_PHASES];
+	volatile NxU32 m_maxUs[NB_PERF_PHASES];
+	volatile NxU32 m_counts[NB_PERF_COUNTS];
+
+	NxReal m_frames[PERF_GRAPH_SIZE];
+	NxU32 m_nextFrame;
+	NxU32 m_firstSlot;
+	NxU32 m_nbSlots;
+	bool m_visible;
+};
+
+///
+/// Record the lifetime of the object as a phase.
+///
+class PerfTimer
+{
+public:
+	PerfTimer(PerfHUD& hud, PerfPhase phase) : m_hud(hud), m_phase(phase), m_start(getPreciseTime()) {}
+	~PerfTimer() { m_hud.Record(m_phase, (NxReal)(getPreciseTime() - m_start)); }
+
+private:
+	PerfTimer(const PerfTimer&);
+	PerfTimer& operator=(const PerfTimer&);
+
+	PerfHUD& m_hud;
+	PerfPhase m_phase;
+	double m_start;
+};
+
+#endif // PERFHUD_H
@@ -0,0 +1,112 @@
+/// \file Pool.h
+///
+/// \brief Fixed size object pool with block allocation and bulk release.
+///
+
+#ifndef POOL_H
+#define POOL_H
+
+#include "NxPhysics.h"
+#include <stdlib.h>
+#include <new>
+
+///
+/// Allocation counters of a pool.
+///
+struct PoolStats
+{
+	NxU32 nbLive;			//objects currently allocated
+	NxU32 nbPeak;			//highest nbLive since the pool was created
+	NxU32 nbAllocations;	//objects handed out since the pool was created
+	NxU32 nbBlocks;			//heap allocations made by the pool
+	NxU32 nbBytes;			//heap memory held by the pool
+};
+
+///
+/// Hands out objects from blocks of blockSize objects, so n objects cost n/blockSize heap allocations.
+///
+/// Reset releases every object at once in constant time and keeps the blocks for reuse; T's
+/// destructor isn't called by Reset, so it's only meant for types that own no resources.
+///
+template<class T>
+class Pool
+{
+public:
+	Pool(NxU32 blockSize = 1024) : m_blockSize(blockSize ? blockSize : 1), m_block(0), m_used(0)
+	{
+		m_stats.nbLive = 0;
+		m_stats.nbPeak = 0;
+		m_stats.nbAllocations = 0;
+		m_stats.nbBlocks = 0;
+		m_stats.nbBytes = 0;
+	}
+
+	~Pool()
+	{
+		for (NxU32 i = 0; i < m_blocks.size(); i++)
+			free(m_blocks[i]);
+	}
+
+	T* Allocate()
+	{
+		void* memory;
+		if (m_free.size())
+		{
+			memory = m_free.back();
+			m_free.popBack();
+		}
+		else
+		{
+			if (m_used == m_blockSize || m_block == m_blocks.size())
+			{
+				//move to the next block, reusing the ones kept by Reset
+				if (m_used == m_blockSize) m_block++;
+				if (m_block == m_blocks.size())
+				{
+					m_blocks.pushBack((T*)malloc(sizeof(T)*m_blockSize));
+					m_stats.nbBlocks++;
+					m_stats.nbBytes += sizeof(T)*m_blockSize;
+				}
+				m_used = 0;
+			}
+			memory = m_blocks[m_block] + m_used++;
+		}
+
+		m_stats.nbAllocations++;
+		if (++m_stats.nbLive > m_stats.nbPeak) m_stats.nbPeak = m_stats.nbLive;
+		return new(memory) T;
+	}
+
+	/// Return a single object to the pool.
+	void Release(T* object)
+	{
+		if (!object) return;
+		object->~T();
+		m_free.pushBack(object);
+		m_stats.nbLive--;
+	}
+
+	/// Release all objects at once.
+	void Reset()
+	{
+		m_free.clear();
+		m_block = 0;
+		m_used = 0;
+		m_stats.nbLive = 0;
+	}
+
+	const PoolStats& GetStats() const { return m_stats; }
+
+private:
+	Pool(const Pool&);
+	Pool& operator=(const Pool&);
+
+	NxU32 m_blockSize;
+	NxArray<T*> m_blocks;
+	NxU32 m_block;		//block currently being filled
+	NxU32 m_used;		//objects used in that block
+	NxArray<T*> m_free;
+	PoolStats m_stats;
+};
+
+#endif // POOL_H
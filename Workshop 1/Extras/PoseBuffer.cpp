@@ -0,0 +1,151 @@
+#include "NxPhysics.h"
+#include "PoseBuffer.h"
+#include "UserData.h"
+
+NxDebugRenderable PoseFrame::GetDebugRenderable() const
+{
+	return NxDebugRenderable(points.size(), points.size() ? &points[0] : 0,
+		lines.size(), lines.size() ? &lines[0] : 0,
+		triangles.size(), triangles.size() ? &triangles[0] : 0);
+}
+
+PoseBuffer::PoseBuffer() : m_write(0), m_read(1), m_ready(2), m_fresh(false), m_readValid(false), m_nbPublished(0)
+{
+}
+
+PoseFrame& PoseBuffer::BeginWrite()
+{
+	PoseFrame& frame = m_frames[m_write];
+	frame.poses.clear();
+	frame.shapes.clear();
+	frame.points.clear();
+	frame.lines.clear();
+	frame.triangles.clear();
+	return frame;
+}
+
+void PoseBuffer::Publish()
+{
+	{
+		ScopedLock lock(m_mutex);
+		NxU32 ready = m_ready;
+		m_ready = m_write;
+		m_write = ready;
+		m_fresh = true;
+	}
+	AtomicStore(&m_nbPublished, m_nbPublished + 1);
+}
+
+void PoseBuffer::Capture(NxScene& scene, NxU32 stepIndex, bool debugData)
+{
+	PoseFrame& frame = BeginWrite();
+	frame.stepIndex = stepIndex;
+
+	NxU32 nbActors = scene.getNbActors();
+	NxActor** actors = scene.getActors();
+	frame.poses.resize(nbActors);
+	for (NxU32 i = 0; i < nbActors; i++)
+	{
+		NxActor* actor = actors[i];
+		ActorUserData* ud = (ActorUserData*)actor->userData;
+		ActorPose& actorPose = frame.poses[i];
+		actorPose.handle = ud ? ud->handle : ActorHandle();
+		actorPose.flags = ud ? ud->flags : 0;
+		actorPose.centerOfMass = actor->isDynamic() ? actor->getCMassGlobalPosition() : actor->getGlobalPosition();
+		actorPose.firstShape = frame.shapes.size();
+		actorPose.nbShapes = actor->getNbShapes();
+
+		NxShape*const* shapes = actor->getShapes();
+		for (NxU32 j = 0; j < actorPose.nbShapes; j++)
+		{
+			NxShape* shape = shapes[j];
+			ShapePose shapePose;
+			shapePose.pose = shape->getGlobalPose();
+			shapePose.type = shape->getType();
+			shapePose.dimensions.zero();
+			shapePose.meshData = 0;
+			switch (shapePose.type)
+			{
+			case NX_SHAPE_BOX:
+				shapePose.dimensions = shape->isBox()->getDimensions();
+				break;
+			case NX_SHAPE_SPHERE:
+				shapePose.dimensions.x = shape->isSphere()->getRadius();
+				break;
+			case NX_SHAPE_CAPSULE:
+				shapePose.dimensions.x = shape->isCapsule()->getRadius();
+				shapePose.dimensions.y = shape->isCapsule()->getHeight();
+				break;
+			case NX_SHAPE_CONVEX:
+			case NX_SHAPE_MESH:
+				shapePose.meshData = GetShapeMeshDesc((ShapeUserData*)shape->userData);
+				break;
+			case NX_SHAPE_WHEEL:
+				{
+					//drawn at the pose saved by the wheel update, NxWheelShape has no width so
+					//it is drawn as wide as its radius, see DrawWheelShape
+					WheelShapeData* wheelData = GetWheelShapeData((ShapeUserData*)shape->userData);
+					if (wheelData)
+					{
+						shapePose.pose = wheelData->pose;
+						shapePose.dimensions.z = wheelData->rollAngle;
+					}
+					shapePose.dimensions.x = shape->isWheel()->getRadius();
+					shapePose.dimensions.y = shapePose.dimensions.x;
+				}
+				break;
+			case NX_SHAPE_HEIGHTFIELD:
+				shapePose.meshData = GetHeightFieldData((ShapeUserData*)shape->userData);
+				break;
+			default:
+				break;
+			}
+			frame.shapes.pushBack(shapePose);
+		}
+	}
+
+	//the debug renderable is only valid until the next step, copy it
+	const NxDebugRenderable* renderable = debugData ? scene.getDebugRenderable() : 0;
+	if (renderable)
+	{
+		frame.points.resize(renderable->getNbPoints());
+		for (NxU32 i = 0; i < frame.points.size(); i++)
+			frame.points[i] = renderable->getPoints()[i];
+		frame.lines.resize(renderable->getNbLines());
+		for (NxU32 i = 0; i < frame.lines.size(); i++)
+			frame.lines[i] = renderable->getLines()[i];
+		frame.triangles.resize(renderable->getNbTriangles());
+		for (NxU32 i = 0; i < frame.triangles.size(); i++)
+			frame.triangles[i] = renderable->getTriangles()[i];
+	}
+
+	Publish();
+}
+
+const PoseFrame* PoseBuffer::AcquireLatest()
+{
+	ScopedLock lock(m_mutex);
+	if (m_fresh)
+	{
+		NxU32 ready = m_ready;
+		m_ready = m_read;
+		m_read = ready;
+		m_fresh = false;
+		m_readValid = true;
+	}
+	return m_readValid ? &m_frames[m_read] : 0;
+}
+
+void PoseBuffer::Clear()
+{
+	for (NxU32 i = 0; i < 3; i++)
+	{
+		m_frames[i].poses.clear();
+		m_frames[i].shapes.clear();
+		m_frames[i].points.clear();
+		m_frames[i].lines.clear();
+		m_frames[i].triangles.clear();
+	}
+	m_fresh = false;
+	m_readValid = false;
+}
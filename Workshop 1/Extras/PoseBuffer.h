@@ -0,0 +1,104 @@
+/// \file PoseBuffer.h
+///
+/// \brief Triple buffered actor and shape poses handed from the simulation thread to the renderer.
+///
+
+#ifndef POSEBUFFER_H
+#define POSEBUFFER_H
+
+#include "NxPhysics.h"
+#include "NxDebugRenderable.h"
+#include "Thread.h"
+#include "ActorHandles.h"
+
+///
+/// One shape at the end of a simulation step, with the size and mesh needed to draw it.
+///
+struct ShapePose
+{
+	NxMat34 pose;			//world pose
+	NxShapeType type;
+	NxVec3 dimensions;		//box half extents, sphere radius in x, capsule radius and height in x and y,
+							//wheel radius, width and roll angle in x, y and z
+	const void* meshData;	//saved NxConvexMeshDesc or NxTriangleMeshDesc of a mesh shape,
+							//HeightFieldData of a heightfield, NULL if none
+};
+
+///
+/// One actor at the end of a simulation step, its shapes are PoseFrame::shapes[firstShape...].
+///
+struct ActorPose
+{
+	ActorHandle handle;		//invalid if the actor has no user data
+	NxVec3 centerOfMass;	//world position
+	NxU32 flags;			//ActorUserData flags, 0 without user data
+	NxU32 firstShape;
+	NxU32 nbShapes;
+};
+
+///
+/// Everything the renderer needs from one simulation step, so it never reads the scene: no
+/// actor or shape is referenced, only copies of their poses, sizes and flags. The mesh
+/// descriptors belong to the MeshRegistry and stay valid until the shapes are released.
+///
+struct PoseFrame
+{
+	NxU32 stepIndex;
+	NxArray<ActorPose> poses;
+	NxArray<ShapePose> shapes;
+
+	//copy of the scene's debug renderable, empty if it wasn't requested
+	NxArray<NxDebugPoint> points;
+	NxArray<NxDebugLine> lines;
+	NxArray<NxDebugTriangle> triangles;
+
+	bool HasDebugData() const { return points.size() || lines.size() || triangles.size(); }
+	NxDebugRenderable GetDebugRenderable() const;
+};
+
+///
+/// Three PoseFrames rotating between one writer and one reader thread.
+///
+/// The writer fills the frame returned by BeginWrite and swaps it with the ready frame in
+/// Publish. The reader swaps the ready frame with its own in AcquireLatest if a newer one was
+/// published, so neither side ever waits for the other to finish a frame and the reader always
+/// gets the latest complete step. Only the index swaps are locked. Frames keep their capacity,
+/// after the first few steps publishing doesn't allocate.
+///
+class PoseBuffer
+{
+public:
+	PoseBuffer();
+
+	/// Writer: frame to fill, cleared.
+	PoseFrame& BeginWrite();
+
+	/// Writer: make the filled frame the latest one.
+	void Publish();
+
+	/// Copy the poses and draw data of all actors and, if requested, the debug renderable of the scene. Writer side.
+	void Capture(NxScene& scene, NxU32 stepIndex, bool debugData);
+
+	/// Reader: latest published frame, NULL if nothing was published yet. Valid until the next call.
+	const PoseFrame* AcquireLatest();
+
+	/// Drop all frames, e.g. when the actors are released. Neither thread may be using the buffer.
+	void Clear();
+
+	NxU32 GetNbPublished() const { return AtomicLoad(&m_nbPublished); }
+
+private:
+	PoseBuffer(const PoseBuffer&);
+	PoseBuffer& operator=(const PoseBuffer&);
+
+	PoseFrame m_frames[3];
+	NxU32 m_write;			//owned by the writer
+	NxU32 m_read;			//owned by the reader
+	NxU32 m_ready;
+	bool m_fresh;			//ready frame not acquired yet
+	bool m_readValid;		//the reader's frame was published at some point
+	volatile NxU32 m_nbPublished;
+	Mutex m_mutex;
+};
+
+#endif // POSEBUFFER_H
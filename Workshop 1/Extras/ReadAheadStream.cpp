@@ -0,0 +1,145 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <string.h>
+#include "NxPhysics.h"
+#include "ReadAheadStream.h"
+
+//at least two blocks are needed to overlap reading and parsing
+static NxU32 ClampBlockCount(NxU32 nbBlocks) { return nbBlocks > 1 ? nbBlocks : 2; }
+
+ReadAheadStream::ReadAheadStream(const char* filename, NxU32 blockSize, NxU32 nbBlocks) :
+	m_fp(NULL), m_blockSize(blockSize ? blockSize : 256*1024), m_nbBlocks(ClampBlockCount(nbBlocks)),
+	m_blocks(0), m_blockSizes(0),
+	m_freeBlocks(ClampBlockCount(nbBlocks), ClampBlockCount(nbBlocks)), m_filledBlocks(0, ClampBlockCount(nbBlocks)),
+	m_thread(0), m_stop(0), m_current(0), m_position(0), m_holdingBlock(false), m_ended(true)
+{
+	m_fp = fopen(filename, "rb");
+	if (!m_fp) return;
+
+	//the CRT buffer would only add a copy on top of our own blocks
+	setvbuf(m_fp, NULL, _IONBF, 0);
+
+	m_blocks = new NxU8[m_blockSize*m_nbBlocks];
+	m_blockSizes = new NxU32[m_nbBlocks];
+	m_current = m_nbBlocks - 1;
+	m_ended = false;
+
+	m_thread = StartThread(IOThread, this);
+	if (!m_thread)
+	{
+		fclose(m_fp);
+		m_fp = NULL;
+		m_ended = true;
+	}
+}
+
+ReadAheadStream::~ReadAheadStream()
+{
+	if (m_thread)
+	{
+		//wake the I/O thread if it is waiting for a free block
+		AtomicStore(&m_stop, 1);
+		m_freeBlocks.Signal(m_nbBlocks);
+		JoinThread(m_thread);
+	}
+	if (m_fp) fclose(m_fp);
+	delete[] m_blocks;
+	delete[] m_blockSizes;
+}
+
+void ReadAheadStream::IOThread(void* param)
+{
+	ReadAheadStream* stream = (ReadAheadStream*)param;
+	NxU32 slot = 0;
+	for (;;)
+	{
+		stream->m_freeBlocks.Wait();
+		if (AtomicLoad(&stream->m_stop)) break;
+
+		NxU8* block = stream->m_blocks + slot*stream->m_blockSize;
+		NxU32 size = (NxU32)fread(block, 1, stream->m_blockSize, stream->m_fp);
+		stream->m_blockSizes[slot] = size;
+		stream->m_filledBlocks.Signal();
+
+		//an empty block marks the end of the file
+		if (!size) break;
+		slot = (slot + 1) % stream->m_nbBlocks;
+	}
+}
+
+bool ReadAheadStream::NextBlock() const
+{
+	if (m_ended) return false;
+
+	//hand the consumed block back to the I/O thread
+	if (m_holdingBlock) m_freeBlocks.Signal();
+	m_holdingBlock = false;
+
+	m_filledBlocks.Wait();
+	m_current = (m_current + 1) % m_nbBlocks;
+	m_position = 0;
+	if (!m_blockSizes[m_current])
+	{
+		m_ended = true;
+		return false;
+	}
+	m_holdingBlock = true;
+	return true;
+}
+
+NxU8 ReadAheadStream::readByte() const
+{
+	NxU8 b;
+	readBuffer(&b, sizeof(NxU8));
+	return b;
+}
+
+NxU16 ReadAheadStream::readWord() const
+{
+	NxU16 w;
+	readBuffer(&w, sizeof(NxU16));
+	return w;
+}
+
+NxU32 ReadAheadStream::readDword() const
+{
+	NxU32 d;
+	readBuffer(&d, sizeof(NxU32));
+	return d;
+}
+
+float ReadAheadStream::readFloat() const
+{
+	float f;
+	readBuffer(&f, sizeof(float));
+	return f;
+}
+
+double ReadAheadStream::readDouble() const
+{
+	double f;
+	readBuffer(&f, sizeof(double));
+	return f;
+}
+
+void ReadAheadStream::readBuffer(void* buffer, NxU32 size) const
+{
+	NxU8* dst = (NxU8*)buffer;
+	while (size)
+	{
+		if ((!m_holdingBlock || m_position == m_blockSizes[m_current]) && !NextBlock())
+		{
+			//reading past the end of the file
+			NX_ASSERT(0);
+			memset(dst, 0, size);
+			return;
+		}
+
+		NxU32 chunk = m_blockSizes[m_current] - m_position;
+		if (chunk > size) chunk = size;
+		memcpy(dst, m_blocks + m_current*m_blockSize + m_position, chunk);
+		m_position += chunk;
+		dst += chunk;
+		size -= chunk;
+	}
+}
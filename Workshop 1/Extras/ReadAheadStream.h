@@ -0,0 +1,63 @@
+/// \file ReadAheadStream.h
+///
+/// \brief File input stream that reads ahead on a background I/O thread.
+///
+
+#ifndef READAHEADSTREAM_H
+#define READAHEADSTREAM_H
+
+#include "NxStream.h"
+#include "Thread.h"
+#include <stdio.h>
+
+///
+/// Drop-in replacement for a loading UserStream.
+///
+/// A background thread fills a ring of nbBlocks buffers from the file while the consumer parses
+/// the blocks read earlier, so disk reads overlap descriptor decoding. Only sequential reading is
+/// supported.
+///
+class ReadAheadStream : public NxStream
+{
+public:
+								ReadAheadStream(const char* filename, NxU32 blockSize = 256*1024, NxU32 nbBlocks = 4);
+	virtual						~ReadAheadStream();
+
+				bool			IsOpen() const { return m_fp != 0; }
+
+	virtual		NxU8			readByte()								const;
+	virtual		NxU16			readWord()								const;
+	virtual		NxU32			readDword()								const;
+	virtual		float			readFloat()								const;
+	virtual		double			readDouble()							const;
+	virtual		void			readBuffer(void* buffer, NxU32 size)	const;
+
+	virtual		NxStream&		storeByte(NxU8 /*b*/)							{ NX_ASSERT(0);	return *this;	}
+	virtual		NxStream&		storeWord(NxU16 /*w*/)							{ NX_ASSERT(0);	return *this;	}
+	virtual		NxStream&		storeDword(NxU32 /*d*/)							{ NX_ASSERT(0);	return *this;	}
+	virtual		NxStream&		storeFloat(NxReal /*f*/)						{ NX_ASSERT(0);	return *this;	}
+	virtual		NxStream&		storeDouble(NxF64 /*f*/)						{ NX_ASSERT(0);	return *this;	}
+	virtual		NxStream&		storeBuffer(const void* /*buffer*/, NxU32 /*size*/)	{ NX_ASSERT(0);	return *this;	}
+
+private:
+	static		void			IOThread(void* param);
+				bool			NextBlock() const;
+
+				FILE*			m_fp;
+				NxU32			m_blockSize;
+				NxU32			m_nbBlocks;
+				NxU8*			m_blocks;
+				NxU32*			m_blockSizes;
+	mutable		Semaphore		m_freeBlocks;
+	mutable		Semaphore		m_filledBlocks;
+				void*			m_thread;
+	volatile	NxU32			m_stop;
+
+	//consumer state
+	mutable		NxU32			m_current;
+	mutable		NxU32			m_position;
+	mutable		bool			m_holdingBlock;
+	mutable		bool			m_ended;
+};
+
+#endif // READAHEADSTREAM_H
@@ -0,0 +1,214 @@
+#include "NxPhysics.h"
+#include "SceneQueryService.h"
+#include "UserData.h"
+
+SceneQueryService::SceneQueryService() : m_scene(0), m_query(0), m_markActors(true)
+{
+}
+
+SceneQueryService::~SceneQueryService()
+{
+	Release();
+}
+
+bool SceneQueryService::Init(NxScene& scene)
+{
+	Release();
+
+	NxSceneQueryDesc desc;
+	desc.report = this;
+	desc.executeMode = NX_SQE_SYNCHRONOUS;
+	m_query = scene.createSceneQuery(desc);
+	if (!m_query) return false;
+	m_scene = &scene;
+	return true;
+}
+
+void SceneQueryService::Release()
+{
+	if (m_query) m_scene->releaseSceneQuery(*m_query);
+	m_query = 0;
+	m_scene = 0;
+
+	m_raycasts.clear();
+	m_sweeps.clear();
+	m_overlaps.clear();
+	m_raycastResults.clear();
+	m_sweepResults.clear();
+	m_overlapResults.clear();
+	m_overlapShapes.clear();
+	m_markedActors.clear();
+}
+
+NxU32 SceneQueryService::AddRaycast(const NxRay& ray, NxReal maxDist, NxShapesType shapeType, NxU32 groups)
+{
+	RaycastQuery query;
+	query.ray = ray;
+	query.maxDist = maxDist;
+	query.shapeType = shapeType;
+	query.groups = groups;
+	m_raycasts.pushBack(query);
+	return m_raycasts.size() - 1;
+}
+
+NxU32 SceneQueryService::AddSweep(const NxBox& box, const NxVec3& motion, NxU32 sweepFlags, NxU32 groups)
+{
+	SweepQuery query;
+	query.box = box;
+	query.motion = motion;
+	query.flags = sweepFlags;
+	query.groups = groups;
+	m_sweeps.pushBack(query);
+	return m_sweeps.size() - 1;
+}
+
+NxU32 SceneQueryService::AddOverlap(const NxSphere& sphere, NxShapesType shapeType, NxU32 groups)
+{
+	OverlapQuery query;
+	query.sphere = sphere;
+	query.shapeType = shapeType;
+	query.groups = groups;
+	m_overlaps.pushBack(query);
+	return m_overlaps.size() - 1;
+}
+
+void SceneQueryService::Execute()
+{
+	if (!m_query) return;
+
+	ClearMarks();
+
+	//queries without a report default to no hit
+	RaycastResult noHit = { NULL, NxVec3(0,0,0), NxVec3(0,0,0), 0 };
+	m_raycastResults.clear();
+	m_raycastResults.resize(m_raycasts.size(), noHit);
+	SweepResult noSweepHit = { NULL, NxVec3(0,0,0), NxVec3(0,0,0), 1 };
+	m_sweepResults.clear();
+	m_sweepResults.resize(m_sweeps.size(), noSweepHit);
+	OverlapResult noOverlap = { 0, 0 };
+	m_overlapResults.clear();
+	m_overlapResults.resize(m_overlaps.size(), noOverlap);
+	m_overlapShapes.clear();
+
+	//the query index travels as the user data and comes back in the report, the hits go to the
+	//report too so no result buffer is passed (0, NULL)
+	NxRaycastHit hit;
+	for (NxU32 i = 0; i < m_raycasts.size(); i++)
+	{
+		const RaycastQuery& query = m_raycasts[i];
+		m_query->raycastClosestShape(query.ray, query.shapeType, hit, query.groups, query.maxDist, 0xffffffff, NULL, NULL, (void*)(size_t)i);
+	}
+	for (NxU32 i = 0; i < m_sweeps.size(); i++)
+	{
+		const SweepQuery& query = m_sweeps[i];
+		m_query->linearOBBSweep(query.box, query.motion, query.flags, (void*)(size_t)i, 0, NULL, NULL, query.groups);
+	}
+	for (NxU32 i = 0; i < m_overlaps.size(); i++)
+	{
+		const OverlapQuery& query = m_overlaps[i];
+		m_query->overlapSphereShapes(query.sphere, query.shapeType, 0, NULL, (void*)(size_t)i, query.groups);
+	}
+
+	m_query->execute();
+	m_query->finish(true);
+
+	m_raycasts.clear();
+	m_sweeps.clear();
+	m_overlaps.clear();
+}
+
+NxQueryReportResult SceneQueryService::onBooleanQuery(void* userData, bool result)
+{
+	return NX_SQR_CONTINUE;
+}
+
+NxQueryReportResult SceneQueryService::onShapeQuery(void* userData, NxU32 nbHits, NxShape** hits)
+{
+	//called once per overlap query, the hits are appended in the order of the queries
+	OverlapResult& result = m_overlapResults[(size_t)userData];
+	result.first = m_overlapShapes.size();
+	result.count = nbHits;
+	for (NxU32 i = 0; i < nbHits; i++)
+	{
+		m_overlapShapes.pushBack(hits[i]);
+		Mark(hits[i], UD_PASSES_INTERSECTION_TEST);
+	}
+	return NX_SQR_CONTINUE;
+}
+
+NxQueryReportResult SceneQueryService::onRaycastQuery(void* userData, NxU32 nbHits, const NxRaycastHit* hits)
+{
+	if (!nbHits) return NX_SQR_CONTINUE;
+
+	RaycastResult& result = m_raycastResults[(size_t)userData];
+	result.shape = hits[0].shape;
+	result.impact = hits[0].worldImpact;
+	result.normal = hits[0].worldNormal;
+	result.distance = hits[0].distance;
+	Mark(result.shape, UD_HIT_BY_RAYCAST);
+	return NX_SQR_CONTINUE;
+}
+
+NxQueryReportResult SceneQueryService::onSweepQuery(void* userData, NxU32 nbHits, NxSweepQueryHit* hits)
+{
+	if (!nbHits) return NX_SQR_CONTINUE;
+
+	//keep the earliest hit
+	NxU32 closest = 0;
+	for (NxU32 i = 1; i < nbHits; i++)
+		if (hits[i].t < hits[closest].t) closest = i;
+
+	SweepResult& result = m_sweepResults[(size_t)userData];
+	result.shape = hits[closest].hitShape;
+	result.point = hits[closest].point;
+	result.normal = hits[closest].normal;
+	result.t = hits[closest].t;
+	Mark(result.shape, UD_PASSES_INTERSECTION_TEST);
+	return NX_SQR_CONTINUE;
+}
+
+void SceneQueryService::Mark(NxShape* shape, NxU32 flag)
+{
+	if (!m_markActors || !shape) return;
+
+	NxActor& actor = shape->getActor();
+	ActorUserData* ud = (ActorUserData*)actor.userData;
+	if (!ud) return;
+
+	//remember each actor once, so the marks can be cleared by the next batch
+	if (!(ud->flags & (UD_HIT_BY_RAYCAST | UD_PASSES_INTERSECTION_TEST)))
+		m_markedActors.pushBack(&actor);
+	ud->flags |= flag;
+}
+
+void SceneQueryService::RemoveActor(NxActor& actor)
+{
+	for (NxU32 i = 0; i < m_raycastResults.size(); i++)
+		if (m_raycastResults[i].shape && &m_raycastResults[i].shape->getActor() == &actor)
+			m_raycastResults[i].shape = NULL;
+	for (NxU32 i = 0; i < m_sweepResults.size(); i++)
+		if (m_sweepResults[i].shape && &m_sweepResults[i].shape->getActor() == &actor)
+			m_sweepResults[i].shape = NULL;
+	for (NxU32 i = 0; i < m_overlapShapes.size(); i++)
+		if (m_overlapShapes[i] && &m_overlapShapes[i]->getActor() == &actor)
+			m_overlapShapes[i] = NULL;
+
+	for (NxU32 i = 0; i < m_markedActors.size(); i++)
+	{
+		if (m_markedActors[i] != &actor) continue;
+		ActorUserData* ud = (ActorUserData*)actor.userData;
+		if (ud) ud->flags &= ~(UD_HIT_BY_RAYCAST | UD_PASSES_INTERSECTION_TEST);
+		m_markedActors.replaceWithLast(i);
+		break;
+	}
+}
+
+void SceneQueryService::ClearMarks()
+{
+	for (NxU32 i = 0; i < m_markedActors.size(); i++)
+	{
+		ActorUserData* ud = (ActorUserData*)m_markedActors[i]->userData;
+		if (ud) ud->flags &= ~(UD_HIT_BY_RAYCAST | UD_PASSES_INTERSECTION_TEST);
+	}
+	m_markedActors.clear();
+}
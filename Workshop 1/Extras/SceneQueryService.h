@@ -0,0 +1,133 @@
+/// \file SceneQueryService.h
+///
+/// \brief Raycasts, sweeps and overlap tests submitted during a frame and run as one batch.
+///
+
+#ifndef SCENEQUERYSERVICE_H
+#define SCENEQUERYSERVICE_H
+
+#include "NxPhysics.h"
+
+///
+/// Closest hit of a raycast, shape is NULL if nothing was hit or its actor was removed since.
+///
+struct RaycastResult
+{
+	NxShape* shape;
+	NxVec3 impact;
+	NxVec3 normal;
+	NxReal distance;
+};
+
+///
+/// Closest hit of a box sweep, shape is NULL if nothing was hit or its actor was removed since.
+///
+struct SweepResult
+{
+	NxShape* shape;
+	NxVec3 point;
+	NxVec3 normal;
+	NxReal t;				//fraction of the motion
+};
+
+///
+/// Shapes overlapping a sphere, a range of GetOverlapShapes(); NULL for a shape whose actor was removed since.
+///
+struct OverlapResult
+{
+	NxU32 first;
+	NxU32 count;
+};
+
+///
+/// Batched scene queries on top of NxSceneQuery.
+///
+/// Queries are queued with the Add functions, which return the index of the result in the next
+/// batch. Execute runs the queued queries in one go and must be called while the scene isn't
+/// being simulated; the results are kept in contiguous arrays until the next Execute. Every
+/// query only considers the shapes of the collision groups in its groups mask, all by default. With
+/// marking enabled the actors hit by a raycast get UD_HIT_BY_RAYCAST and the actors found by a
+/// sweep or an overlap get UD_PASSES_INTERSECTION_TEST, until the next Execute.
+///
+class SceneQueryService : public NxSceneQueryReport
+{
+public:
+	SceneQueryService();
+	virtual ~SceneQueryService();
+
+	bool Init(NxScene& scene);
+	void Release();
+
+	NxU32 AddRaycast(const NxRay& ray, NxReal maxDist = NX_MAX_F32, NxShapesType shapeType = NX_ALL_SHAPES, NxU32 groups = 0xffffffff);
+	NxU32 AddSweep(const NxBox& box, const NxVec3& motion, NxU32 sweepFlags = NX_SF_STATICS | NX_SF_DYNAMICS, NxU32 groups = 0xffffffff);
+	NxU32 AddOverlap(const NxSphere& sphere, NxShapesType shapeType = NX_ALL_SHAPES, NxU32 groups = 0xffffffff);
+
+	/// Run all queued queries and replace the previous results.
+	void Execute();
+
+	void SetMarkActors(bool mark) { m_markActors = mark; }
+
+	/// Forget an actor before it is released: its marks and its shapes in the last results.
+	void RemoveActor(NxActor& actor);
+
+	NxU32 GetNbRaycasts() const { return m_raycastResults.size(); }
+	const RaycastResult* GetRaycastResults() const { return m_raycastResults.size() ? &m_raycastResults[0] : 0; }
+	NxU32 GetNbSweeps() const { return m_sweepResults.size(); }
+	const SweepResult* GetSweepResults() const { return m_sweepResults.size() ? &m_sweepResults[0] : 0; }
+	NxU32 GetNbOverlaps() const { return m_overlapResults.size(); }
+	const OverlapResult* GetOverlapResults() const { return m_overlapResults.size() ? &m_overlapResults[0] : 0; }
+	NxShape* const* GetOverlapShapes() const { return m_overlapShapes.size() ? &m_overlapShapes[0] : 0; }
+
+	virtual NxQueryReportResult onBooleanQuery(void* userData, bool result);
+	virtual NxQueryReportResult onShapeQuery(void* userData, NxU32 nbHits, NxShape** hits);
+	virtual NxQueryReportResult onRaycastQuery(void* userData, NxU32 nbHits, const NxRaycastHit* hits);
+	virtual NxQueryReportResult onSweepQuery(void* userData, NxU32 nbHits, NxSweepQueryHit* hits);
+
+private:
+	SceneQueryService(const SceneQueryService&);
+	SceneQueryService& operator=(const SceneQueryService&);
+
+	void Mark(NxShape* shape, NxU32 flag);
+	void ClearMarks();
+
+	struct RaycastQuery
+	{
+		NxRay ray;
+		NxReal maxDist;
+		NxShapesType shapeType;
+		NxU32 groups;			//collision groups to test, one bit per group
+	};
+
+	struct SweepQuery
+	{
+		NxBox box;
+		NxVec3 motion;
+		NxU32 flags;
+		NxU32 groups;
+	};
+
+	struct OverlapQuery
+	{
+		NxSphere sphere;
+		NxShapesType shapeType;
+		NxU32 groups;
+	};
+
+	NxScene* m_scene;
+	NxSceneQuery* m_query;
+	bool m_markActors;
+
+	//queued for the next batch
+	NxArray<RaycastQuery> m_raycasts;
+	NxArray<SweepQuery> m_sweeps;
+	NxArray<OverlapQuery> m_overlaps;
+
+	//results of the last batch
+	NxArray<RaycastResult> m_raycastResults;
+	NxArray<SweepResult> m_sweepResults;
+	NxArray<OverlapResult> m_overlapResults;
+	NxArray<NxShape*> m_overlapShapes;
+	NxArray<NxActor*> m_markedActors;
+};
+
+#endif // SCENEQUERYSERVICE_H
@@ -0,0 +1,120 @@
+#include "NxPhysics.h"
+#include "SceneSnapshot.h"
+#include "UserData.h"
+
+static const NxU32 SNAPSHOT_MAGIC = 0x50414e53;	//"SNAP"
+static const NxU32 SNAPSHOT_END = 0x444e4553;	//"SEND", a short read is zero filled and can't match it
+static const NxU32 SNAPSHOT_VERSION = 2;
+
+//a unit quaternion, zero filled or corrupt states are rejected
+static bool IsValidState(const ActorState& state)
+{
+	NxReal magnitude = state.orientation.magnitudeSquared();
+	return magnitude > 0.9f && magnitude < 1.1f &&
+		state.position.isFinite() && state.linearVelocity.isFinite() && state.angularVelocity.isFinite();
+}
+
+void SceneSnapshot::Capture(NxScene& scene)
+{
+	NxU32 nbActors = scene.getNbActors();
+	NxActor** actors = scene.getActors();
+
+	m_states.clear();
+	m_states.reserve(nbActors);
+	for (NxU32 i = 0; i < nbActors; i++)
+	{
+		NxActor* actor = actors[i];
+		ActorState state;
+		state.position = actor->getGlobalPosition();
+		state.orientation = actor->getGlobalOrientationQuat();
+		state.stateFlags = 0;
+		state.userFlags = actor->userData ? ((ActorUserData*)actor->userData)->flags & ~UD_RUNTIME_FLAGS : 0;
+
+		if (actor->isDynamic())
+		{
+			state.linearVelocity = actor->getLinearVelocity();
+			state.angularVelocity = actor->getAngularVelocity();
+			state.stateFlags |= AS_DYNAMIC;
+			if (actor->isSleeping()) state.stateFlags |= AS_SLEEPING;
+			if (actor->readBodyFlag(NX_BF_KINEMATIC)) state.stateFlags |= AS_KINEMATIC;
+		}
+		else
+		{
+			state.linearVelocity.zero();
+			state.angularVelocity.zero();
+		}
+		m_states.pushBack(state);
+	}
+}
+
+bool SceneSnapshot::Restore(NxScene& scene) const
+{
+	NxU32 nbActors = scene.getNbActors();
+	if (nbActors != m_states.size()) return false;
+
+	NxActor** actors = scene.getActors();
+	for (NxU32 i = 0; i < nbActors; i++)
+	{
+		NxActor* actor = actors[i];
+		const ActorState& state = m_states[i];
+
+		//the runtime flags stay as the reports and services set them
+		if (actor->userData)
+		{
+			ActorUserData* ud = (ActorUserData*)actor->userData;
+			ud->flags = (ud->flags & UD_RUNTIME_FLAGS) | (state.userFlags & ~UD_RUNTIME_FLAGS);
+		}
+
+		//static actors can't move, only their user flags are restored
+		if (!actor->isDynamic() || !(state.stateFlags & AS_DYNAMIC)) continue;
+
+		NxMat34 pose;
+		pose.M.fromQuat(state.orientation);
+		pose.t = state.position;
+		actor->setGlobalPose(pose);
+
+		if (state.stateFlags & AS_KINEMATIC) continue;
+
+		actor->setLinearVelocity(state.linearVelocity);
+		actor->setAngularVelocity(state.angularVelocity);
+		if (state.stateFlags & AS_SLEEPING)
+			actor->putToSleep();
+		else
+			actor->wakeUp();
+	}
+	return true;
+}
+
+void SceneSnapshot::Save(NxStream& stream) const
+{
+	stream.storeDword(SNAPSHOT_MAGIC);
+	stream.storeDword(SNAPSHOT_VERSION);
+	stream.storeDword(sizeof(ActorState));
+	stream.storeDword(m_states.size());
+	if (m_states.size())
+		stream.storeBuffer(&m_states[0], m_states.size()*sizeof(ActorState));
+	stream.storeDword(SNAPSHOT_END);
+}
+
+bool SceneSnapshot::Load(const NxStream& stream, NxU32 nbActors)
+{
+	m_states.clear();
+	if (stream.readDword() != SNAPSHOT_MAGIC) return false;
+	if (stream.readDword() != SNAPSHOT_VERSION) return false;
+	if (stream.readDword() != sizeof(ActorState)) return false;
+
+	//checked before allocating, a corrupt count can't ask for more than the scene has
+	if (stream.readDword() != nbActors) return false;
+
+	if (nbActors)
+	{
+		m_states.resize(nbActors);
+		stream.readBuffer(&m_states[0], nbActors*sizeof(ActorState));
+	}
+
+	bool valid = stream.readDword() == SNAPSHOT_END;
+	for (NxU32 i = 0; valid && i < nbActors; i++)
+		if (m_states[i].stateFlags & AS_DYNAMIC) valid = IsValidState(m_states[i]);
+	if (!valid) m_states.clear();
+	return valid;
+}
@@ -0,0 +1,58 @@
+/// \file SceneSnapshot.h
+///
+/// \brief Capture, save and restore the dynamic state of every actor in a scene.
+///
+
+#ifndef SCENESNAPSHOT_H
+#define SCENESNAPSHOT_H
+
+#include "NxPhysics.h"
+
+enum ActorStateFlag
+{
+	AS_DYNAMIC		= (1<<0),
+	AS_SLEEPING		= (1<<1),
+	AS_KINEMATIC	= (1<<2),
+};
+
+///
+/// State of a single actor, stored as is in the snapshot file.
+///
+struct ActorState
+{
+	NxVec3 position;
+	NxQuat orientation;
+	NxVec3 linearVelocity;
+	NxVec3 angularVelocity;
+	NxU32 stateFlags;	//ActorStateFlag
+	NxU32 userFlags;	//ActorUserData::flags without UD_RUNTIME_FLAGS, 0 if the actor has no user data
+};
+
+///
+/// State of all actors of a scene, in the order of NxScene::getActors().
+///
+/// A snapshot can be restored any number of times, e.g. to run several continuations from one
+/// checkpoint. Capture and Restore must not be called while a simulation step is running.
+///
+class SceneSnapshot
+{
+public:
+	void Capture(NxScene& scene);
+
+	/// Apply the snapshot. Fails if the scene doesn't have the same number of actors.
+	bool Restore(NxScene& scene) const;
+
+	/// Write/read the snapshot in one bulk transfer through any stream. Load fails without
+	/// allocating if the file isn't for a scene of nbActors actors, and on a truncated file.
+	void Save(NxStream& stream) const;
+	bool Load(const NxStream& stream, NxU32 nbActors);
+
+	NxU32 GetNbActors() const { return m_states.size(); }
+	const ActorState* GetStates() const { return m_states.size() ? &m_states[0] : 0; }
+	void Clear() { m_states.clear(); }
+
+private:
+	NxArray<ActorState> m_states;
+};
+
+#endif // SCENESNAPSHOT_H
@@ -0,0 +1,88 @@
+#include "NxPhysics.h"
+#include "SimulationThread.h"
+#include "Timing.h"
+
+SimulationThread::SimulationThread() :
+	m_function(0), m_onStart(0), m_onExit(0), m_context(0), m_timeStep(1.0f/60.0f), m_maxStepsPerTick(4), m_thread(0), m_stop(0), m_nbSteps(0), m_nbSkipped(0)
+{
+}
+
+SimulationThread::~SimulationThread()
+{
+	Stop();
+}
+
+bool SimulationThread::Start(SimulationStepFunction function, void* context, NxReal timeStep, NxU32 maxStepsPerTick)
+{
+	Stop();
+	if (!function || timeStep <= 0) return false;
+
+	m_function = function;
+	m_context = context;
+	m_timeStep = timeStep;
+	m_maxStepsPerTick = maxStepsPerTick ? maxStepsPerTick : 1;
+	m_stop = 0;
+	m_nbSteps = 0;
+	m_nbSkipped = 0;
+
+	m_thread = StartThread(ThreadMain, this);
+	return m_thread != 0;
+}
+
+void SimulationThread::SetThreadFunctions(SimulationThreadFunction onStart, SimulationThreadFunction onExit)
+{
+	m_onStart = onStart;
+	m_onExit = onExit;
+}
+
+void SimulationThread::Stop()
+{
+	if (!m_thread) return;
+
+	AtomicStore(&m_stop, 1);
+	JoinThread(m_thread);
+	m_thread = 0;
+}
+
+void SimulationThread::ThreadMain(void* param)
+{
+	SimulationThread* thread = (SimulationThread*)param;
+	if (thread->m_onStart) thread->m_onStart(thread->m_context);
+	thread->Run();
+	if (thread->m_onExit) thread->m_onExit(thread->m_context);
+}
+
+void SimulationThread::Run()
+{
+	//whole milliseconds from getTime, the differences stay exact however long the program runs
+	unsigned long previousTime = getTime();
+	NxReal accumulator = m_timeStep;	//step right away
+
+	while (!AtomicLoad(&m_stop))
+	{
+		unsigned long currentTime = getTime();
+		accumulator += (currentTime - previousTime)*0.001f;
+		previousTime = currentTime;
+
+		if (accumulator < m_timeStep)
+		{
+			SleepFor((NxU32)((m_timeStep - accumulator)*1000.0f));
+			continue;
+		}
+
+		for (NxU32 i = 0; i < m_maxStepsPerTick && accumulator >= m_timeStep; i++)
+		{
+			m_function(m_context, m_timeStep);
+			accumulator -= m_timeStep;
+			AtomicStore(&m_nbSteps, m_nbSteps + 1);
+		}
+
+		//too far behind, give up on the missed steps
+		if (accumulator >= m_timeStep)
+		{
+			NxU32 nbSkipped = (NxU32)(accumulator/m_timeStep);
+			accumulator -= nbSkipped*m_timeStep;
+			AtomicStore(&m_nbSkipped, m_nbSkipped + nbSkipped);
+		}
+	}
+}
@@ -0,0 +1,63 @@
+/// \file SimulationThread.h
+///
+/// \brief Run the simulation steps on their own thread at a fixed rate.
+///
+
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+#include "NxPhysics.h"
+#include "Thread.h"
+
+/// One fixed step of simulation, called on the simulation thread.
+typedef void (*SimulationStepFunction)(void* context, NxReal timeStep);
+
+/// Called on the simulation thread when it starts or before it ends.
+typedef void (*SimulationThreadFunction)(void* context);
+
+///
+/// Calls a step function at a fixed rate on a dedicated thread.
+///
+/// The thread sleeps until the next step is due. If the steps take longer than real time it
+/// runs at most maxStepsPerTick of them back to back and drops the rest, counted in
+/// GetNbSkipped(), instead of falling further and further behind.
+///
+class SimulationThread
+{
+public:
+	SimulationThread();
+	~SimulationThread();
+
+	bool Start(SimulationStepFunction function, void* context, NxReal timeStep = 1.0f/60.0f, NxU32 maxStepsPerTick = 4);
+
+	/// Functions called on the thread around the steps of the following starts, either can be 0.
+	void SetThreadFunctions(SimulationThreadFunction onStart, SimulationThreadFunction onExit);
+
+	/// Wait for the current step to finish and end the thread.
+	void Stop();
+
+	bool IsRunning() const { return m_thread != 0; }
+	NxReal GetTimeStep() const { return m_timeStep; }
+	NxU32 GetNbSteps() const { return AtomicLoad(&m_nbSteps); }
+	NxU32 GetNbSkipped() const { return AtomicLoad(&m_nbSkipped); }
+
+private:
+	SimulationThread(const SimulationThread&);
+	SimulationThread& operator=(const SimulationThread&);
+
+	static void ThreadMain(void* param);
+	void Run();
+
+	SimulationStepFunction m_function;
+	SimulationThreadFunction m_onStart;
+	SimulationThreadFunction m_onExit;
+	void* m_context;
+	NxReal m_timeStep;
+	NxU32 m_maxStepsPerTick;
+	void* m_thread;
+	volatile NxU32 m_stop;
+	volatile NxU32 m_nbSteps;
+	volatile NxU32 m_nbSkipped;
+};
+
+#endif // SIMULATIONTHREAD_H
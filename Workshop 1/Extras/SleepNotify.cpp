@@ -0,0 +1,89 @@
+#include "NxPhysics.h"
+#include "SleepNotify.h"
+#include "UserData.h"
+
+void SleepNotify::Attach(NxScene& scene)
+{
+	scene.setUserNotify(this);
+	Rebuild(scene);
+}
+
+void SleepNotify::Rebuild(NxScene& scene)
+{
+	m_awake.clear();
+
+	NxU32 nbActors = scene.getNbActors();
+	NxActor** actors = scene.getActors();
+	for (NxU32 i = 0; i < nbActors; i++)
+	{
+		ActorUserData* ud = (ActorUserData*)actors[i]->userData;
+		if (!ud) continue;
+
+		ud->awakeIndex = INVALID_AWAKE_INDEX;
+		Track(*actors[i]);
+	}
+}
+
+void SleepNotify::Track(NxActor& actor)
+{
+	ActorUserData* ud = (ActorUserData*)actor.userData;
+	if (!ud) return;
+
+	ud->flags &= ~UD_IS_ASLEEP;
+	if (!actor.isDynamic()) return;
+
+	if (actor.isSleeping())
+		ud->flags |= UD_IS_ASLEEP;
+	else
+		Add(actor);
+}
+
+void SleepNotify::Add(NxActor& actor)
+{
+	ActorUserData* ud = (ActorUserData*)actor.userData;
+	if (!ud || ud->awakeIndex != INVALID_AWAKE_INDEX) return;
+
+	ud->awakeIndex = m_awake.size();
+	m_awake.pushBack(&actor);
+}
+
+void SleepNotify::Remove(NxActor& actor)
+{
+	ActorUserData* ud = (ActorUserData*)actor.userData;
+	if (!ud || ud->awakeIndex == INVALID_AWAKE_INDEX) return;
+
+	//move the last actor into the hole
+	NxActor* last = m_awake.back();
+	m_awake[ud->awakeIndex] = last;
+	((ActorUserData*)last->userData)->awakeIndex = ud->awakeIndex;
+	m_awake.popBack();
+	ud->awakeIndex = INVALID_AWAKE_INDEX;
+}
+
+bool SleepNotify::onJointBreak(NxReal breakingImpulse, NxJoint& brokenJoint)
+{
+	//keep the joint, it's released by whoever created it
+	return false;
+}
+
+void SleepNotify::onWake(NxActor** actors, NxU32 count)
+{
+	for (NxU32 i = 0; i < count; i++)
+	{
+		ActorUserData* ud = (ActorUserData*)actors[i]->userData;
+		if (!ud) continue;
+		ud->flags &= ~UD_IS_ASLEEP;
+		Add(*actors[i]);
+	}
+}
+
+void SleepNotify::onSleep(NxActor** actors, NxU32 count)
+{
+	for (NxU32 i = 0; i < count; i++)
+	{
+		ActorUserData* ud = (ActorUserData*)actors[i]->userData;
+		if (!ud) continue;
+		ud->flags |= UD_IS_ASLEEP;
+		Remove(*actors[i]);
+	}
+}
@@ -0,0 +1,47 @@
+/// \file SleepNotify.h
+///
+/// \brief Set of awake actors kept up to date by the sleep and wake notifications.
+///
+
+#ifndef SLEEPNOTIFY_H
+#define SLEEPNOTIFY_H
+
+#include "NxPhysics.h"
+
+///
+/// User notify that keeps a dense array of the awake dynamic actors and UD_IS_ASLEEP.
+///
+/// onWake/onSleep are called during fetchResults for the actors that changed state, each
+/// change costs O(1): the actor's position in the array is kept in ActorUserData::awakeIndex
+/// and leaving actors are swapped with the last one. Only actors with ActorUserData are
+/// tracked. Call Rebuild after adding user data or after changing the sleep state of actors
+/// directly, e.g. when restoring a snapshot.
+///
+class SleepNotify : public NxUserNotify
+{
+public:
+	void Attach(NxScene& scene);
+
+	/// Recompute the awake set from isSleeping() of all actors.
+	void Rebuild(NxScene& scene);
+
+	/// Start tracking an actor created after Attach, call once it has its user data.
+	void Track(NxActor& actor);
+
+	/// Stop tracking an actor, call before releasing it.
+	void Remove(NxActor& actor);
+
+	NxU32 GetNbAwake() const { return m_awake.size(); }
+	NxActor* const* GetAwakeActors() const { return m_awake.size() ? &m_awake[0] : 0; }
+
+	virtual bool onJointBreak(NxReal breakingImpulse, NxJoint& brokenJoint);
+	virtual void onWake(NxActor** actors, NxU32 count);
+	virtual void onSleep(NxActor** actors, NxU32 count);
+
+private:
+	void Add(NxActor& actor);
+
+	NxArray<NxActor*> m_awake;
+};
+
+#endif // SLEEPNOTIFY_H
@@ -155,7 +155,8 @@ NxStream& MemoryWriteBuffer::storeBuffer(const void* buffer, NxU32 size)
 	NxU32 expectedSize = currentSize + size;
 	if(expectedSize > maxSize)
 	{
-		maxSize = expectedSize + 4096;
+		//grow geometrically so large cooked meshes don't copy the buffer on every store
+		maxSize = expectedSize + (expectedSize>>1) + 4096;
 
 		NxU8* newData = (NxU8*)NxGetPhysicsSDKAllocator()->malloc(maxSize, NX_MEMORY_PERSISTENT);
 		if(data)
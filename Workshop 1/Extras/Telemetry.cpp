@@ -0,0 +1,158 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <string.h>
+#include "NxPhysics.h"
+#include "Telemetry.h"
+
+static const NxU32 TELEMETRY_VERSION = 1;
+static const NxU32 TELEMETRY_BATCH = 4096;
+
+TelemetryWriter::TelemetryWriter() :
+	m_fp(NULL), m_format(TELEMETRY_BINARY), m_mask(0), m_thread(0), m_stop(0), m_head(0), m_tail(0), m_nbDropped(0)
+{
+}
+
+TelemetryWriter::~TelemetryWriter()
+{
+	Stop();
+}
+
+bool TelemetryWriter::Start(const char* filename, TelemetryFormat format, NxU32 capacity)
+{
+	Stop();
+
+	m_fp = fopen(filename, format == TELEMETRY_CSV ? "w" : "wb");
+	if (!m_fp) return false;
+	m_format = format;
+
+	if (m_format == TELEMETRY_CSV)
+	{
+		fprintf(m_fp, "step,actor,px,py,pz,vx,vy,vz\n");
+	}
+	else
+	{
+		NxU32 header[3] = { TELEMETRY_MAGIC, TELEMETRY_VERSION, TELEMETRY_NB_COLUMNS };
+		fwrite(header, sizeof(header), 1, m_fp);
+	}
+
+	NxU32 size = 64;
+	while (size < capacity && size < 0x80000000) size <<= 1;
+	m_records.clear();
+	m_records.resize(size);
+	m_mask = size - 1;
+	m_head = 0;
+	m_tail = 0;
+	m_nbDropped = 0;
+	m_stop = 0;
+
+	m_thread = StartThread(WriterThread, this);
+	if (!m_thread)
+	{
+		Stop();
+		return false;
+	}
+	return true;
+}
+
+void TelemetryWriter::Stop()
+{
+	if (m_thread)
+	{
+		AtomicStore(&m_stop, 1);
+		JoinThread(m_thread);
+		m_thread = 0;
+	}
+
+	if (m_fp) fclose(m_fp);
+	m_fp = NULL;
+}
+
+bool TelemetryWriter::Push(const TelemetryRecord& record)
+{
+	if (!m_thread) return false;
+
+	NxU32 head = m_head;
+	if (head - AtomicLoad(&m_tail) > m_mask)
+	{
+		m_nbDropped++;
+		return false;
+	}
+
+	m_records[head & m_mask] = record;
+	AtomicStore(&m_head, head + 1);
+	return true;
+}
+
+bool TelemetryWriter::Push(NxU32 step, NxU32 actorId, NxActor& actor)
+{
+	TelemetryRecord record;
+	record.step = step;
+	record.actorId = actorId;
+	record.position = actor.getGlobalPosition();
+	if (actor.isDynamic())
+		record.velocity = actor.getLinearVelocity();
+	else
+		record.velocity.zero();
+	return Push(record);
+}
+
+void TelemetryWriter::WriterThread(void* param)
+{
+	TelemetryWriter* writer = (TelemetryWriter*)param;
+	NxU32 tail = writer->m_tail;
+	for (;;)
+	{
+		//read the flag first so records pushed before Stop are always seen
+		NxU32 stop = AtomicLoad(&writer->m_stop);
+		NxU32 head = AtomicLoad(&writer->m_head);
+		if (head == tail)
+		{
+			if (stop) break;
+			SleepFor(1);
+			continue;
+		}
+
+		NxU32 count = head - tail;
+		if (count > TELEMETRY_BATCH) count = TELEMETRY_BATCH;
+		if (writer->m_format == TELEMETRY_CSV)
+			writer->WriteCSV(tail, count);
+		else
+			writer->WriteBinary(tail, count);
+
+		tail += count;
+		AtomicStore(&writer->m_tail, tail);
+	}
+	fflush(writer->m_fp);
+}
+
+void TelemetryWriter::WriteBinary(NxU32 first, NxU32 count)
+{
+	//transpose the records so each column is contiguous in the file
+	m_columns.resize(count*TELEMETRY_NB_COLUMNS);
+	NxU32* columns = &m_columns[0];
+	for (NxU32 i = 0; i < count; i++)
+	{
+		const TelemetryRecord& record = m_records[(first + i) & m_mask];
+		columns[i] = record.step;
+		columns[count + i] = record.actorId;
+		memcpy(&columns[2*count + i], &record.position.x, sizeof(NxReal));
+		memcpy(&columns[3*count + i], &record.position.y, sizeof(NxReal));
+		memcpy(&columns[4*count + i], &record.position.z, sizeof(NxReal));
+		memcpy(&columns[5*count + i], &record.velocity.x, sizeof(NxReal));
+		memcpy(&columns[6*count + i], &record.velocity.y, sizeof(NxReal));
+		memcpy(&columns[7*count + i], &record.velocity.z, sizeof(NxReal));
+	}
+	fwrite(&count, sizeof(count), 1, m_fp);
+	fwrite(columns, sizeof(NxU32), count*TELEMETRY_NB_COLUMNS, m_fp);
+}
+
+void TelemetryWriter::WriteCSV(NxU32 first, NxU32 count)
+{
+	for (NxU32 i = 0; i < count; i++)
+	{
+		const TelemetryRecord& record = m_records[(first + i) & m_mask];
+		fprintf(m_fp, "%u,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n", record.step, record.actorId,
+			record.position.x, record.position.y, record.position.z,
+			record.velocity.x, record.velocity.y, record.velocity.z);
+	}
+}
@@ -0,0 +1,85 @@
+/// \file Telemetry.h
+///
+/// \brief Asynchronous per-actor telemetry written to a columnar binary or CSV file.
+///
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "NxPhysics.h"
+#include "Thread.h"
+#include <stdio.h>
+
+///
+/// One sample of an actor's state.
+///
+struct TelemetryRecord
+{
+	NxU32 step;
+	NxU32 actorId;
+	NxVec3 position;
+	NxVec3 velocity;
+};
+
+enum TelemetryFormat
+{
+	TELEMETRY_BINARY,	//header, then blocks of count followed by one array per column
+	TELEMETRY_CSV,		//one line per record
+};
+
+static const NxU32 TELEMETRY_MAGIC = 0x314d4c54;	//"TLM1"
+static const NxU32 TELEMETRY_NB_COLUMNS = 8;		//step, actorId, position xyz, velocity xyz
+
+///
+/// Telemetry sink with formatting and file output done off the simulation thread.
+///
+/// Push copies a record into a single producer, single consumer ring without locking or
+/// allocating; a writer thread drains the ring in batches. If the ring is full the record is
+/// dropped and counted rather than stalling the caller. Push must always be called from the same thread.
+///
+class TelemetryWriter
+{
+public:
+	TelemetryWriter();
+	~TelemetryWriter();
+
+	/// Start writing to a file. The capacity is rounded up to a power of two.
+	bool Start(const char* filename, TelemetryFormat format = TELEMETRY_BINARY, NxU32 capacity = 16384);
+
+	/// Write the queued records and close the file.
+	void Stop();
+
+	bool IsRunning() const { return m_thread != 0; }
+
+	/// Queue a record, returns false if it was dropped.
+	bool Push(const TelemetryRecord& record);
+
+	/// Queue a record of the actor's current pose and velocity.
+	bool Push(NxU32 step, NxU32 actorId, NxActor& actor);
+
+	NxU32 GetNbWritten() const { return AtomicLoad(&m_tail); }
+	NxU32 GetNbDropped() const { return m_nbDropped; }
+
+private:
+	TelemetryWriter(const TelemetryWriter&);
+	TelemetryWriter& operator=(const TelemetryWriter&);
+
+	static void WriterThread(void* param);
+	void WriteBinary(NxU32 first, NxU32 count);
+	void WriteCSV(NxU32 first, NxU32 count);
+
+	FILE* m_fp;
+	TelemetryFormat m_format;
+	NxArray<TelemetryRecord> m_records;
+	NxU32 m_mask;
+	void* m_thread;
+	volatile NxU32 m_stop;
+
+	volatile NxU32 m_head;	//written by the producer only
+	volatile NxU32 m_tail;	//written by the writer thread only
+	NxU32 m_nbDropped;
+
+	NxArray<NxU32> m_columns;	//writer thread
+};
+
+#endif // TELEMETRY_H
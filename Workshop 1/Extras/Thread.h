@@ -0,0 +1,120 @@
+/// \file Thread.h
+///
+/// \brief Minimal threading primitives: worker threads, locks, semaphores, atomics and a parallel loop.
+///
+
+#ifndef THREAD_H
+#define THREAD_H
+
+#include "Nx.h"
+
+/// Entry point of a worker thread.
+typedef void (*ThreadFunction)(void* param);
+
+/// Body of a parallel loop, called once per index.
+typedef void (*ParallelForFunction)(void* context, NxU32 index);
+
+/// Start a new thread running function(param). Returns an opaque handle for JoinThread.
+void* StartThread(ThreadFunction function, void* param);
+
+/// Wait for a thread to finish and release its handle.
+void JoinThread(void* thread);
+
+/// Number of logical processors available to the process.
+NxU32 GetNumberOfCores();
+
+/// Suspend the calling thread.
+void SleepFor(NxU32 milliseconds);
+
+/// Atomically increment/decrement a value and return the new value.
+NxI32 AtomicIncrement(volatile NxI32* value);
+NxI32 AtomicDecrement(volatile NxI32* value);
+
+/// Read a value written by another thread (acquire).
+NxU32 AtomicLoad(const volatile NxU32* value);
+
+/// Publish a value to other threads (release).
+void AtomicStore(volatile NxU32* value, NxU32 newValue);
+
+///
+/// Non-recursive lock.
+///
+class Mutex
+{
+public:
+	Mutex();
+	~Mutex();
+
+	void Lock();
+	void Unlock();
+
+private:
+	Mutex(const Mutex&);
+	Mutex& operator=(const Mutex&);
+
+	void* m_handle;
+};
+
+///
+/// Lock a mutex for the lifetime of the object.
+///
+class ScopedLock
+{
+public:
+	ScopedLock(Mutex& mutex) : m_mutex(mutex) { m_mutex.Lock(); }
+	~ScopedLock() { m_mutex.Unlock(); }
+
+private:
+	ScopedLock(const ScopedLock&);
+	ScopedLock& operator=(const ScopedLock&);
+
+	Mutex& m_mutex;
+};
+
+///
+/// Pointer with a separate value for every thread, 0 until the thread sets it.
+///
+class ThreadLocal
+{
+public:
+	ThreadLocal();
+	~ThreadLocal();
+
+	void* Get() const;
+	void Set(void* value);
+
+private:
+	ThreadLocal(const ThreadLocal&);
+	ThreadLocal& operator=(const ThreadLocal&);
+
+	NxU32 m_index;
+};
+
+///
+/// Counting semaphore.
+///
+class Semaphore
+{
+public:
+	Semaphore(NxU32 initialCount, NxU32 maxCount);
+	~Semaphore();
+
+	void Wait();
+	/// Wait at most the given time, returns false on timeout.
+	bool Wait(NxU32 milliseconds);
+	void Signal(NxU32 count = 1);
+
+private:
+	Semaphore(const Semaphore&);
+	Semaphore& operator=(const Semaphore&);
+
+	void* m_handle;
+};
+
+///
+/// Run function(context, i) for i in [0, count) on up to nbThreads threads (0 = one per core).
+/// The calling thread takes part in the work; returns when all indices are done.
+///
+void ParallelFor(NxU32 count, ParallelForFunction function, void* context, NxU32 nbThreads = 0);
+
+#endif // THREAD_H
@@ -0,0 +1,190 @@
+#define NOMINMAX
+#include <windows.h>
+#include <process.h>
+#include "Nx.h"
+#include "Thread.h"
+
+struct ThreadStart
+{
+	ThreadFunction function;
+	void* param;
+};
+
+static unsigned __stdcall ThreadEntry(void* arg)
+{
+	ThreadStart start = *(ThreadStart*)arg;
+	delete (ThreadStart*)arg;
+	start.function(start.param);
+	return 0;
+}
+
+void* StartThread(ThreadFunction function, void* param)
+{
+	ThreadStart* start = new ThreadStart;
+	start->function = function;
+	start->param = param;
+
+	HANDLE thread = (HANDLE)_beginthreadex(NULL, 0, ThreadEntry, start, 0, NULL);
+	if (!thread)
+	{
+		delete start;
+		return 0;
+	}
+	return thread;
+}
+
+void JoinThread(void* thread)
+{
+	if (!thread) return;
+	WaitForSingleObject((HANDLE)thread, INFINITE);
+	CloseHandle((HANDLE)thread);
+}
+
+NxU32 GetNumberOfCores()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+}
+
+void SleepFor(NxU32 milliseconds)
+{
+	Sleep(milliseconds);
+}
+
+NxI32 AtomicIncrement(volatile NxI32* value)
+{
+	return InterlockedIncrement((volatile LONG*)value);
+}
+
+NxI32 AtomicDecrement(volatile NxI32* value)
+{
+	return InterlockedDecrement((volatile LONG*)value);
+}
+
+NxU32 AtomicLoad(const volatile NxU32* value)
+{
+	NxU32 v = *value;
+	MemoryBarrier();
+	return v;
+}
+
+void AtomicStore(volatile NxU32* value, NxU32 newValue)
+{
+	MemoryBarrier();
+	*value = newValue;
+}
+
+Mutex::Mutex()
+{
+	CRITICAL_SECTION* cs = new CRITICAL_SECTION;
+	InitializeCriticalSectionAndSpinCount(cs, 1000);
+	m_handle = cs;
+}
+
+Mutex::~Mutex()
+{
+	DeleteCriticalSection((CRITICAL_SECTION*)m_handle);
+	delete (CRITICAL_SECTION*)m_handle;
+}
+
+void Mutex::Lock()
+{
+	EnterCriticalSection((CRITICAL_SECTION*)m_handle);
+}
+
+void Mutex::Unlock()
+{
+	LeaveCriticalSection((CRITICAL_SECTION*)m_handle);
+}
+
+ThreadLocal::ThreadLocal()
+{
+	m_index = TlsAlloc();
+}
+
+ThreadLocal::~ThreadLocal()
+{
+	if (m_index != TLS_OUT_OF_INDEXES) TlsFree(m_index);
+}
+
+void* ThreadLocal::Get() const
+{
+	return TlsGetValue(m_index);
+}
+
+void ThreadLocal::Set(void* value)
+{
+	TlsSetValue(m_index, value);
+}
+
+Semaphore::Semaphore(NxU32 initialCount, NxU32 maxCount)
+{
+	m_handle = CreateSemaphore(NULL, initialCount, maxCount, NULL);
+}
+
+Semaphore::~Semaphore()
+{
+	CloseHandle((HANDLE)m_handle);
+}
+
+void Semaphore::Wait()
+{
+	WaitForSingleObject((HANDLE)m_handle, INFINITE);
+}
+
+bool Semaphore::Wait(NxU32 milliseconds)
+{
+	return WaitForSingleObject((HANDLE)m_handle, milliseconds) == WAIT_OBJECT_0;
+}
+
+void Semaphore::Signal(NxU32 count)
+{
+	ReleaseSemaphore((HANDLE)m_handle, count, NULL);
+}
+
+struct ParallelForTask
+{
+	ParallelForFunction function;
+	void* context;
+	NxU32 count;
+	volatile NxI32 next;
+};
+
+static void ParallelForWorker(void* param)
+{
+	ParallelForTask* task = (ParallelForTask*)param;
+	for (;;)
+	{
+		NxU32 index = (NxU32)(AtomicIncrement(&task->next) - 1);
+		if (index >= task->count) break;
+		task->function(task->context, index);
+	}
+}
+
+void ParallelFor(NxU32 count, ParallelForFunction function, void* context, NxU32 nbThreads)
+{
+	if (!count) return;
+	if (!nbThreads) nbThreads = GetNumberOfCores();
+	if (nbThreads > count) nbThreads = count;
+
+	ParallelForTask task;
+	task.function = function;
+	task.context = context;
+	task.count = count;
+	task.next = 0;
+
+	//the calling thread is one of the workers
+	HANDLE threads[MAXIMUM_WAIT_OBJECTS];
+	NxU32 nbStarted = 0;
+	for (NxU32 i = 1; i < nbThreads && nbStarted < MAXIMUM_WAIT_OBJECTS; i++)
+	{
+		void* thread = StartThread(ParallelForWorker, &task);
+		if (thread) threads[nbStarted++] = (HANDLE)thread;
+	}
+
+	ParallelForWorker(&task);
+
+	for (NxU32 i = 0; i < nbStarted; i++)
+		JoinThread(threads[i]);
+}
@@ -4,5 +4,6 @@
 	unsigned long getTime();
 	float getCurrentTime();
 	float getElapsedTime();
+	double getPreciseTime();
 
 #endif
@@ -35,3 +35,13 @@ float getElapsedTime()
 	return (float)(elapsedTime)/(freq.QuadPart);
 }
 
+
+double getPreciseTime()
+{
+	// no cached state, can be called from any thread
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	LARGE_INTEGER currentTime;
+	QueryPerformanceCounter(&currentTime);
+	return (double)currentTime.QuadPart/(double)freq.QuadPart;
+}
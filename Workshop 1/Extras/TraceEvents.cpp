@@ -0,0 +1,275 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <string.h>
+#include "NxPhysics.h"
+#include "TraceEvents.h"
+
+static const NxU32 TRACE_FLUSH_INTERVAL = 100;	//milliseconds between writes of the writer thread
+
+TraceLog::TraceLog(NxU32 capacity) :
+	m_mask(0), m_recording(0), m_fp(NULL), m_format(TRACE_JSON), m_startTime(0), m_nbWritten(0), m_thread(0), m_stop(0)
+{
+	NxU32 size = 64;
+	while (size < capacity && size < 0x80000000) size <<= 1;
+	m_mask = size - 1;
+}
+
+TraceLog::~TraceLog()
+{
+	Stop();
+	for (NxU32 i = 0; i < m_threads.size(); i++)
+		delete m_threads[i];
+	for (NxU32 i = 0; i < m_free.size(); i++)
+		delete m_free[i];
+}
+
+bool TraceLog::Start(const char* filename, TraceFormat format)
+{
+	Stop();
+
+	ScopedLock lock(m_lock);
+	m_fp = fopen(filename, format == TRACE_JSON ? "w" : "wb");
+	if (!m_fp) return false;
+	m_format = format;
+
+	if (m_format == TRACE_JSON)
+	{
+		//the closing bracket is optional, a trace cut short by a crash still loads
+		fprintf(m_fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	}
+	else
+	{
+		TraceFileHeader header;
+		header.magic = TRACE_MAGIC;
+		header.version = TRACE_VERSION;
+		fwrite(&header, sizeof(header), 1, m_fp);
+	}
+
+	for (NxU32 i = 0; i < m_threads.size(); i++)
+	{
+		ThreadBuffer* buffer = m_threads[i];
+		AtomicStore(&buffer->tail, AtomicLoad(&buffer->head));
+		buffer->nameWritten = false;
+	}
+	m_names.clear();
+	m_nbWritten = 0;
+	m_startTime = getPreciseTime();
+	m_stop = 0;
+
+	m_thread = StartThread(WriterThread, this);
+	if (!m_thread)
+	{
+		fclose(m_fp);
+		m_fp = NULL;
+		return false;
+	}
+	AtomicStore(&m_recording, 1);
+	return true;
+}
+
+void TraceLog::Stop()
+{
+	if (!m_thread) return;
+
+	AtomicStore(&m_recording, 0);
+	AtomicStore(&m_stop, 1);
+	JoinThread(m_thread);
+	m_thread = 0;
+
+	Flush();
+
+	ScopedLock lock(m_lock);
+	if (m_format == TRACE_JSON)
+		fprintf(m_fp, "\n]}\n");
+	fclose(m_fp);
+	m_fp = NULL;
+}
+
+void TraceLog::WriterThread(void* param)
+{
+	TraceLog* log = (TraceLog*)param;
+	while (!AtomicLoad(&log->m_stop))
+	{
+		SleepFor(TRACE_FLUSH_INTERVAL);
+		log->Flush();
+	}
+}
+
+void TraceLog::Flush()
+{
+	ScopedLock lock(m_lock);
+	if (!m_fp) return;
+
+	for (NxU32 i = 0; i < m_threads.size(); i++)
+		WriteBuffer(*m_threads[i]);
+	fflush(m_fp);
+}
+
+void TraceLog::SetThreadName(const char* name)
+{
+	m_localName.Set((void*)name);
+
+	ThreadBuffer* buffer = (ThreadBuffer*)m_local.Get();
+	if (!buffer || buffer->name == name) return;
+
+	ScopedLock lock(m_lock);
+	buffer->name = name;
+	buffer->nameWritten = false;
+}
+
+void TraceLog::ReleaseThread()
+{
+	ThreadBuffer* buffer = (ThreadBuffer*)m_local.Get();
+	m_local.Set(0);
+	m_localName.Set(0);
+	if (!buffer) return;
+
+	//the thread pushes no more events, write them now so the next thread can take the ring
+	ScopedLock lock(m_lock);
+	if (m_fp)
+		WriteBuffer(*buffer);
+	for (NxU32 i = 0; i < m_threads.size(); i++)
+	{
+		if (m_threads[i] == buffer)
+		{
+			//the order of the list doesn't matter, the ids stay with the rings
+			m_threads.replaceWithLast(i);
+			m_free.pushBack(buffer);
+			break;
+		}
+	}
+}
+
+NxU32 TraceLog::GetNbDropped() const
+{
+	ScopedLock lock(m_lock);
+	NxU32 nbDropped = 0;
+	for (NxU32 i = 0; i < m_threads.size(); i++)
+		nbDropped += m_threads[i]->nbDropped;
+	for (NxU32 i = 0; i < m_free.size(); i++)
+		nbDropped += m_free[i]->nbDropped;
+	return nbDropped;
+}
+
+void TraceLog::Push(const char* name, NxU32 type)
+{
+	if (!AtomicLoad(&m_recording)) return;
+
+	ThreadBuffer* buffer = GetThreadBuffer();
+	NxU32 head = buffer->head;
+	if (head - AtomicLoad(&buffer->tail) > m_mask)
+	{
+		buffer->nbDropped++;
+		return;
+	}
+
+	TraceEvent& event = buffer->events[head & m_mask];
+	event.name = name;
+	event.type = type;
+	event.time = getPreciseTime();
+	AtomicStore(&buffer->head, head + 1);
+}
+
+TraceLog::ThreadBuffer* TraceLog::GetThreadBuffer()
+{
+	ThreadBuffer* buffer = (ThreadBuffer*)m_local.Get();
+	if (buffer) return buffer;
+
+	//first event of this thread while recording, take the ring of a thread that ended if any
+	ScopedLock lock(m_lock);
+	if (m_free.size())
+	{
+		buffer = m_free.back();
+		m_free.popBack();
+		buffer->tail = buffer->head;
+	}
+	else
+	{
+		buffer = new ThreadBuffer;
+		buffer->events.resize(m_mask + 1);
+		buffer->head = 0;
+		buffer->tail = 0;
+		buffer->nbDropped = 0;
+		buffer->id = m_threads.size();
+	}
+	buffer->name = (const char*)m_localName.Get();
+	buffer->nameWritten = false;
+
+	m_threads.pushBack(buffer);
+	m_local.Set(buffer);
+	return buffer;
+}
+
+void TraceLog::WriteBuffer(ThreadBuffer& buffer)
+{
+	if (!buffer.nameWritten && buffer.name)
+		WriteThreadName(buffer);
+
+	NxU32 head = AtomicLoad(&buffer.head);
+	for (NxU32 tail = buffer.tail; tail != head; tail++)
+	{
+		//a thread can still be finishing an event it began before Start
+		const TraceEvent& event = buffer.events[tail & m_mask];
+		if (event.time >= m_startTime)
+			WriteEvent(buffer, event);
+	}
+	AtomicStore(&buffer.tail, head);
+}
+
+void TraceLog::WriteThreadName(ThreadBuffer& buffer)
+{
+	if (m_format == TRACE_JSON)
+	{
+		fprintf(m_fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			m_nbWritten ? ",\n" : "", buffer.id, buffer.name);
+	}
+	else
+	{
+		WriteString(TRACE_THREAD, 0, buffer.id, buffer.name);
+	}
+	buffer.nameWritten = true;
+	AtomicStore(&m_nbWritten, m_nbWritten + 1);
+}
+
+void TraceLog::WriteEvent(const ThreadBuffer& buffer, const TraceEvent& event)
+{
+	double time = (event.time - m_startTime)*1000000.0;
+	if (m_format == TRACE_JSON)
+	{
+		fprintf(m_fp, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+			m_nbWritten ? ",\n" : "", event.name, event.type == TRACE_BEGIN ? 'B' : 'E', buffer.id, time);
+	}
+	else
+	{
+		TraceRecord record;
+		record.name = (NxU16)GetNameId(event.name);
+		record.thread = (NxU16)buffer.id;
+		record.type = event.type;
+		record.time = (NxU64)time;
+		fwrite(&record, sizeof(record), 1, m_fp);
+	}
+	AtomicStore(&m_nbWritten, m_nbWritten + 1);
+}
+
+NxU32 TraceLog::GetNameId(const char* name)
+{
+	//only a handful of distinct names, all string literals
+	for (NxU32 i = 0; i < m_names.size(); i++)
+		if (m_names[i] == name) return i;
+
+	NxU32 id = m_names.size();
+	m_names.pushBack(name);
+	WriteString(TRACE_NAME, id, 0, name);
+	return id;
+}
+
+void TraceLog::WriteString(NxU32 type, NxU32 name, NxU32 thread, const char* string)
+{
+	TraceRecord record;
+	record.name = (NxU16)name;
+	record.thread = (NxU16)thread;
+	record.type = type;
+	record.time = strlen(string);
+	fwrite(&record, sizeof(record), 1, m_fp);
+	fwrite(string, (size_t)record.time, 1, m_fp);
+}
@@ -0,0 +1,158 @@
+/// \file TraceEvents.h
+///
+/// \brief Timestamped begin/end events per thread, written as Chrome trace JSON or a compact binary trace.
+///
+/// The JSON output opens in chrome://tracing or ui.perfetto.dev. The binary output is a
+/// TraceFileHeader followed by TraceRecords; a name or thread is defined by a TRACE_NAME or
+/// TRACE_THREAD record before its first use, with the length of the string in place of the time
+/// and the characters following the record. The id of a thread that ended can be given to a
+/// later thread, which then defines it again with its own name.
+///
+
+#ifndef TRACEEVENTS_H
+#define TRACEEVENTS_H
+
+#include "NxPhysics.h"
+#include "Thread.h"
+#include "Timing.h"
+#include <stdio.h>
+
+enum TraceFormat
+{
+	TRACE_JSON,
+	TRACE_BINARY,
+};
+
+enum TraceEventType
+{
+	TRACE_BEGIN,
+	TRACE_END,
+	TRACE_NAME,		//binary only, defines the name id
+	TRACE_THREAD,	//binary only, names the thread id
+};
+
+static const NxU32 TRACE_MAGIC = 0x31435254;	//"TRC1"
+static const NxU32 TRACE_VERSION = 2;			//16 byte records with a 64 bit time
+
+struct TraceFileHeader
+{
+	NxU32 magic;
+	NxU32 version;
+};
+
+struct TraceRecord
+{
+	NxU16 name;
+	NxU16 thread;
+	NxU32 type;
+	NxU64 time;		//microseconds since Start
+};
+
+///
+/// Collects begin/end events from any number of threads.
+///
+/// Every thread records into its own single producer, single consumer ring, so Begin and End
+/// neither lock nor allocate once the thread's first event registered the ring. A ring is only
+/// registered for a thread that records while a trace is running, and a thread that ends hands
+/// its ring back with ReleaseThread for the next thread to reuse. A writer thread drains the
+/// rings to the file a few times per second; if a ring is full the event is dropped and counted.
+/// Names are kept by pointer, use string literals without quotes or backslashes.
+///
+class TraceLog
+{
+public:
+	/// capacity is the number of events buffered per thread, rounded up to a power of two.
+	TraceLog(NxU32 capacity = 16384);
+	~TraceLog();
+
+	/// Start recording to a file, events of an earlier recording still in the rings are discarded.
+	bool Start(const char* filename, TraceFormat format = TRACE_JSON);
+
+	/// Write the remaining events and close the file.
+	void Stop();
+
+	bool IsRecording() const { return AtomicLoad(&m_recording) != 0; }
+
+	/// Write the buffered events of all threads now.
+	void Flush();
+
+	/// Name the calling thread in the trace, call it once when the thread starts.
+	void SetThreadName(const char* name);
+
+	/// Called by a thread before it ends, its events are written and its ring is reused.
+	void ReleaseThread();
+
+	void Begin(const char* name) { Push(name, TRACE_BEGIN); }
+	void End(const char* name) { Push(name, TRACE_END); }
+
+	/// Records written by the current recording, and events dropped since the log was created.
+	NxU32 GetNbWritten() const { return AtomicLoad(&m_nbWritten); }
+	NxU32 GetNbDropped() const;
+
+private:
+	TraceLog(const TraceLog&);
+	TraceLog& operator=(const TraceLog&);
+
+	struct TraceEvent
+	{
+		const char* name;
+		double time;
+		NxU32 type;
+	};
+
+	struct ThreadBuffer
+	{
+		NxArray<TraceEvent> events;
+		volatile NxU32 head;	//written by the owning thread only
+		volatile NxU32 tail;	//written by Flush only
+		volatile NxU32 nbDropped;
+		const char* name;
+		NxU32 id;
+		bool nameWritten;
+	};
+
+	static void WriterThread(void* param);
+	void Push(const char* name, NxU32 type);
+	ThreadBuffer* GetThreadBuffer();
+	void WriteBuffer(ThreadBuffer& buffer);
+	void WriteThreadName(ThreadBuffer& buffer);
+	void WriteEvent(const ThreadBuffer& buffer, const TraceEvent& event);
+	NxU32 GetNameId(const char* name);
+	void WriteString(NxU32 type, NxU32 name, NxU32 thread, const char* string);
+
+	NxU32 m_mask;
+	ThreadLocal m_local;
+	ThreadLocal m_localName;	//name of the thread until it registers a ring
+	volatile NxU32 m_recording;
+
+	mutable Mutex m_lock;	//guards the thread lists, the names and the file
+	NxArray<ThreadBuffer*> m_threads;
+	NxArray<ThreadBuffer*> m_free;	//rings of threads that ended
+	NxArray<const char*> m_names;
+	FILE* m_fp;
+	TraceFormat m_format;
+	double m_startTime;
+	volatile NxU32 m_nbWritten;
+
+	void* m_thread;
+	volatile NxU32 m_stop;
+};
+
+///
+/// Record the lifetime of the object as a begin/end pair.
+///
+class TraceScope
+{
+public:
+	TraceScope(TraceLog& log, const char* name) : m_log(log), m_name(name) { m_log.Begin(m_name); }
+	~TraceScope() { m_log.End(m_name); }
+
+private:
+	TraceScope(const TraceScope&);
+	TraceScope& operator=(const TraceScope&);
+
+	TraceLog& m_log;
+	const char* m_name;
+};
+
+#endif // TRACEEVENTS_H
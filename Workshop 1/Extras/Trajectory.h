@@ -0,0 +1,116 @@
+/// \file Trajectory.h
+///
+/// \brief File format shared by the trajectory recorder and player.
+///
+/// A trajectory file is a TrajectoryFileHeader followed by frames. Each frame is a
+/// TrajectoryFrameHeader and a payload with seven values per actor: the position quantized to
+/// 1/positionScale metres and the orientation quaternion quantized to 16 bits per component.
+/// Keyframes store the values themselves, other frames store the difference to the previous
+/// frame. Values are zigzag encoded variable length integers, so actors at rest cost a byte per value.
+///
+
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include "NxPhysics.h"
+
+static const NxU32 TRAJECTORY_MAGIC = 0x4a415254;	//"TRAJ"
+static const NxU32 TRAJECTORY_VERSION = 1;
+static const NxU32 TRAJECTORY_VALUES_PER_ACTOR = 7;
+static const NxReal TRAJECTORY_QUAT_SCALE = 32767.0f;
+
+enum TrajectoryFrameFlag
+{
+	TF_KEYFRAME = (1<<0),
+};
+
+struct TrajectoryFileHeader
+{
+	NxU32 magic;
+	NxU32 version;
+	NxReal positionScale;
+	NxU32 keyframeInterval;
+};
+
+struct TrajectoryFrameHeader
+{
+	NxU32 frameIndex;
+	NxU32 nbActors;
+	NxU32 flags;
+	NxU32 payloadSize;
+};
+
+///
+/// Pose of one actor as copied from the scene.
+///
+struct TrajectoryPose
+{
+	NxVec3 position;
+	NxQuat orientation;
+};
+
+inline NxI32 QuantizeValue(NxReal v, NxReal scale)
+{
+	NxReal q = v*scale;
+	if (q > 2147483520.0f) q = 2147483520.0f;
+	if (q < -2147483520.0f) q = -2147483520.0f;
+	return (NxI32)(q < 0 ? q - 0.5f : q + 0.5f);
+}
+
+inline void QuantizePose(const TrajectoryPose& pose, NxReal positionScale, NxI32* values)
+{
+	//q and -q are the same rotation, keep w positive so consecutive frames stay close
+	NxReal sign = pose.orientation.w < 0 ? -1.0f : 1.0f;
+	values[0] = QuantizeValue(pose.position.x, positionScale);
+	values[1] = QuantizeValue(pose.position.y, positionScale);
+	values[2] = QuantizeValue(pose.position.z, positionScale);
+	values[3] = QuantizeValue(sign*pose.orientation.x, TRAJECTORY_QUAT_SCALE);
+	values[4] = QuantizeValue(sign*pose.orientation.y, TRAJECTORY_QUAT_SCALE);
+	values[5] = QuantizeValue(sign*pose.orientation.z, TRAJECTORY_QUAT_SCALE);
+	values[6] = QuantizeValue(sign*pose.orientation.w, TRAJECTORY_QUAT_SCALE);
+}
+
+inline void DequantizePose(const NxI32* values, NxReal positionScale, TrajectoryPose& pose)
+{
+	pose.position.set(values[0]/positionScale, values[1]/positionScale, values[2]/positionScale);
+	pose.orientation.setXYZW(values[3]/TRAJECTORY_QUAT_SCALE, values[4]/TRAJECTORY_QUAT_SCALE,
+		values[5]/TRAJECTORY_QUAT_SCALE, values[6]/TRAJECTORY_QUAT_SCALE);
+	pose.orientation.normalize();
+}
+
+inline NxU32 ZigZagEncode(NxI32 v)
+{
+	return ((NxU32)v << 1) ^ (NxU32)(v >> 31);
+}
+
+inline NxI32 ZigZagDecode(NxU32 v)
+{
+	return (NxI32)(v >> 1) ^ -(NxI32)(v & 1);
+}
+
+/// Append a variable length integer, at most 5 bytes.
+inline NxU8* WriteVarInt(NxU8* out, NxU32 v)
+{
+	while (v >= 0x80)
+	{
+		*out++ = (NxU8)(v | 0x80);
+		v >>= 7;
+	}
+	*out++ = (NxU8)v;
+	return out;
+}
+
+/// Read a variable length integer, returns 0 on truncated input.
+inline const NxU8* ReadVarInt(const NxU8* in, const NxU8* end, NxU32& v)
+{
+	v = 0;
+	for (NxU32 shift = 0; shift < 35 && in < end; shift += 7)
+	{
+		NxU8 b = *in++;
+		v |= (NxU32)(b & 0x7f) << shift;
+		if (!(b & 0x80)) return in;
+	}
+	return 0;
+}
+
+#endif // TRAJECTORY_H
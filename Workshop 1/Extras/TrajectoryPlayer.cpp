@@ -0,0 +1,127 @@
+#include <string.h>
+#include "NxPhysics.h"
+#include "TrajectoryPlayer.h"
+
+static const NxU32 NO_FRAME = 0xffffffff;
+
+TrajectoryPlayer::TrajectoryPlayer() : m_positionScale(1024.0f), m_currentFrame(NO_FRAME)
+{
+}
+
+bool TrajectoryPlayer::Open(const char* filename)
+{
+	Close();
+	if (!m_file.Open(filename)) return false;
+
+	const NxU8* data = m_file.GetData();
+	NxU32 size = m_file.GetSize();
+
+	TrajectoryFileHeader header;
+	if (size < sizeof(header))
+	{
+		Close();
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != TRAJECTORY_MAGIC || header.version != TRAJECTORY_VERSION || !(header.positionScale > 0))
+	{
+		Close();
+		return false;
+	}
+	m_positionScale = header.positionScale;
+
+	//index the frames, a delta frame must follow a frame with the same number of actors
+	NxU32 offset = sizeof(header);
+	NxU32 keyframe = NO_FRAME;
+	NxU32 nbActors = 0;
+	while (size - offset >= sizeof(TrajectoryFrameHeader))
+	{
+		TrajectoryFrameHeader frame;
+		memcpy(&frame, data + offset, sizeof(frame));
+		if (frame.payloadSize > size - offset - sizeof(frame)) break;
+
+		if (frame.flags & TF_KEYFRAME)
+		{
+			keyframe = m_frameOffsets.size();
+			nbActors = frame.nbActors;
+		}
+		else if (keyframe == NO_FRAME || frame.nbActors != nbActors)
+			break;
+
+		m_frameOffsets.pushBack(offset);
+		m_keyframes.pushBack(keyframe);
+		offset += sizeof(frame) + frame.payloadSize;
+	}
+
+	if (!m_frameOffsets.size())
+	{
+		Close();
+		return false;
+	}
+	return Seek(0);
+}
+
+void TrajectoryPlayer::Close()
+{
+	m_file.Close();
+	m_frameOffsets.clear();
+	m_keyframes.clear();
+	m_values.clear();
+	m_poses.clear();
+	m_currentFrame = NO_FRAME;
+}
+
+bool TrajectoryPlayer::Seek(NxU32 frame)
+{
+	if (!m_frameOffsets.size()) return false;
+	if (frame >= m_frameOffsets.size()) frame = m_frameOffsets.size() - 1;
+	if (frame == m_currentFrame) return true;
+
+	//keep decoding forward from the current frame if it's past the frame's keyframe
+	NxU32 first = m_keyframes[frame];
+	if (m_currentFrame != NO_FRAME && m_currentFrame < frame && m_currentFrame >= first)
+		first = m_currentFrame + 1;
+
+	for (NxU32 i = first; i <= frame; i++)
+	{
+		if (!DecodeFrame(i))
+		{
+			m_currentFrame = NO_FRAME;
+			return false;
+		}
+	}
+	m_currentFrame = frame;
+
+	NxU32 nbActors = m_values.size()/TRAJECTORY_VALUES_PER_ACTOR;
+	m_poses.resize(nbActors);
+	for (NxU32 i = 0; i < nbActors; i++)
+		DequantizePose(&m_values[i*TRAJECTORY_VALUES_PER_ACTOR], m_positionScale, m_poses[i]);
+	return true;
+}
+
+bool TrajectoryPlayer::DecodeFrame(NxU32 frame)
+{
+	const NxU8* data = m_file.GetData() + m_frameOffsets[frame];
+	TrajectoryFrameHeader header;
+	memcpy(&header, data, sizeof(header));
+
+	NxU32 nbValues = header.nbActors*TRAJECTORY_VALUES_PER_ACTOR;
+	if (header.flags & TF_KEYFRAME)
+	{
+		m_values.clear();
+		m_values.resize(nbValues, 0);
+	}
+	else if (m_values.size() != nbValues)
+		return false;
+
+	const NxU8* in = data + sizeof(header);
+	const NxU8* end = in + header.payloadSize;
+	for (NxU32 i = 0; i < nbValues; i++)
+	{
+		NxU32 v;
+		in = ReadVarInt(in, end, v);
+		if (!in) return false;
+		m_values[i] = (NxI32)((NxU32)m_values[i] + (NxU32)ZigZagDecode(v));
+	}
+	return true;
+}
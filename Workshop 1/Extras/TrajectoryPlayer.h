@@ -0,0 +1,51 @@
+/// \file TrajectoryPlayer.h
+///
+/// \brief Play back a trajectory file written by TrajectoryRecorder.
+///
+
+#ifndef TRAJECTORYPLAYER_H
+#define TRAJECTORYPLAYER_H
+
+#include "NxPhysics.h"
+#include "Trajectory.h"
+#include "FileMapping.h"
+
+///
+/// Random access to the frames of a memory mapped trajectory file.
+///
+/// Open builds an index of the frame offsets and of the keyframe each frame depends on, so a
+/// seek decodes at most one keyframe interval. Stepping forward one frame decodes a single delta.
+/// A truncated last frame, e.g. from a recording that was cut short, is ignored.
+///
+class TrajectoryPlayer
+{
+public:
+	TrajectoryPlayer();
+
+	bool Open(const char* filename);
+	void Close();
+	bool IsOpen() const { return m_file.IsOpen(); }
+
+	/// Decode the poses of the given frame, clamped to the last frame.
+	bool Seek(NxU32 frame);
+
+	NxU32 GetNbFrames() const { return m_frameOffsets.size(); }
+	NxU32 GetCurrentFrame() const { return m_currentFrame; }
+
+	/// Poses of the current frame, in the order of NxScene::getActors() at recording time.
+	NxU32 GetNbActors() const { return m_poses.size(); }
+	const TrajectoryPose* GetPoses() const { return m_poses.size() ? &m_poses[0] : 0; }
+
+private:
+	bool DecodeFrame(NxU32 frame);
+
+	FileMapping m_file;
+	NxReal m_positionScale;
+	NxArray<NxU32> m_frameOffsets;
+	NxArray<NxU32> m_keyframes;		//keyframe to decode from, per frame
+	NxArray<NxI32> m_values;		//quantized values of the current frame
+	NxArray<TrajectoryPose> m_poses;
+	NxU32 m_currentFrame;
+};
+
+#endif // TRAJECTORYPLAYER_H
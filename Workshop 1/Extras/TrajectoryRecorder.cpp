@@ -0,0 +1,166 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include "NxPhysics.h"
+#include "TrajectoryRecorder.h"
+
+TrajectoryRecorder::TrajectoryRecorder() :
+	m_fp(NULL), m_positionScale(1024.0f), m_keyframeInterval(60), m_freeSlots(0), m_filledSlots(0),
+	m_thread(0), m_stop(0), m_writeSlot(0), m_nbFrames(0), m_nbStalls(0), m_readSlot(0), m_nbEncoded(0), m_bytesWritten(0)
+{
+}
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+	Stop();
+}
+
+bool TrajectoryRecorder::Start(const char* filename, NxReal positionScale, NxU32 keyframeInterval, NxU32 nbSlots)
+{
+	Stop();
+
+	m_fp = fopen(filename, "wb");
+	if (!m_fp) return false;
+
+	m_positionScale = positionScale > 0 ? positionScale : 1024.0f;
+	m_keyframeInterval = keyframeInterval ? keyframeInterval : 1;
+	if (nbSlots < 2) nbSlots = 2;
+
+	TrajectoryFileHeader header;
+	header.magic = TRAJECTORY_MAGIC;
+	header.version = TRAJECTORY_VERSION;
+	header.positionScale = m_positionScale;
+	header.keyframeInterval = m_keyframeInterval;
+	fwrite(&header, sizeof(header), 1, m_fp);
+
+	m_slots.clear();
+	m_slots.resize(nbSlots);
+	m_freeSlots = new Semaphore(nbSlots, nbSlots);
+	m_filledSlots = new Semaphore(0, nbSlots + 1);	//+1 for the stop signal
+	m_stop = 0;
+	m_writeSlot = 0;
+	m_readSlot = 0;
+	m_nbFrames = 0;
+	m_nbStalls = 0;
+	m_nbEncoded = 0;
+	m_bytesWritten = sizeof(header);
+	m_previous.clear();
+
+	m_thread = StartThread(WriterThread, this);
+	if (!m_thread)
+	{
+		Stop();
+		return false;
+	}
+	return true;
+}
+
+void TrajectoryRecorder::Stop()
+{
+	if (m_thread)
+	{
+		//the writer drains all queued frames before it acts on the stop flag
+		AtomicStore(&m_stop, 1);
+		m_filledSlots->Signal();
+		JoinThread(m_thread);
+		m_thread = 0;
+	}
+
+	delete m_freeSlots;
+	delete m_filledSlots;
+	m_freeSlots = 0;
+	m_filledSlots = 0;
+
+	if (m_fp) fclose(m_fp);
+	m_fp = NULL;
+}
+
+void TrajectoryRecorder::RecordFrame(NxScene& scene)
+{
+	if (!m_thread) return;
+
+	if (!m_freeSlots->Wait(0))
+	{
+		//the writer is behind, wait for it rather than dropping the frame
+		m_nbStalls++;
+		m_freeSlots->Wait();
+	}
+
+	FrameSlot& slot = m_slots[m_writeSlot];
+	slot.frameIndex = m_nbFrames;
+
+	NxU32 nbActors = scene.getNbActors();
+	NxActor** actors = scene.getActors();
+	slot.poses.resize(nbActors);
+	for (NxU32 i = 0; i < nbActors; i++)
+	{
+		slot.poses[i].position = actors[i]->getGlobalPosition();
+		slot.poses[i].orientation = actors[i]->getGlobalOrientationQuat();
+	}
+
+	m_writeSlot = (m_writeSlot + 1) % m_slots.size();
+	AtomicStore(&m_nbFrames, m_nbFrames + 1);
+	m_filledSlots->Signal();
+}
+
+void TrajectoryRecorder::WriterThread(void* param)
+{
+	TrajectoryRecorder* recorder = (TrajectoryRecorder*)param;
+	for (;;)
+	{
+		recorder->m_filledSlots->Wait();
+
+		//a wake-up without a queued frame is the stop signal
+		if (recorder->m_nbEncoded == AtomicLoad(&recorder->m_nbFrames))
+		{
+			if (AtomicLoad(&recorder->m_stop)) break;
+			continue;
+		}
+
+		recorder->EncodeFrame(recorder->m_readSlot);
+		recorder->m_nbEncoded++;
+		recorder->m_readSlot = (recorder->m_readSlot + 1) % recorder->m_slots.size();
+		recorder->m_freeSlots->Signal();
+	}
+	fflush(recorder->m_fp);
+}
+
+void TrajectoryRecorder::EncodeFrame(NxU32 slotIndex)
+{
+	const FrameSlot& slot = m_slots[slotIndex];
+	NxU32 nbActors = slot.poses.size();
+	NxU32 nbValues = nbActors*TRAJECTORY_VALUES_PER_ACTOR;
+
+	TrajectoryFrameHeader header;
+	header.frameIndex = slot.frameIndex;
+	header.nbActors = nbActors;
+	header.flags = 0;
+
+	//a changed actor count has no previous frame to diff against
+	if (slot.frameIndex % m_keyframeInterval == 0 || m_previous.size() != nbValues)
+	{
+		header.flags |= TF_KEYFRAME;
+		m_previous.clear();
+		m_previous.resize(nbValues, 0);
+	}
+
+	m_payload.resize(nbValues*5 + 1);
+	NxU8* out = m_payload.size() ? &m_payload[0] : 0;
+	NxU8* start = out;
+	NxI32 values[TRAJECTORY_VALUES_PER_ACTOR];
+	for (NxU32 i = 0; i < nbActors; i++)
+	{
+		QuantizePose(slot.poses[i], m_positionScale, values);
+		NxI32* previous = &m_previous[i*TRAJECTORY_VALUES_PER_ACTOR];
+		for (NxU32 j = 0; j < TRAJECTORY_VALUES_PER_ACTOR; j++)
+		{
+			NxI32 delta = (NxI32)((NxU32)values[j] - (NxU32)previous[j]);
+			out = WriteVarInt(out, ZigZagEncode(delta));
+			previous[j] = values[j];
+		}
+	}
+	header.payloadSize = (NxU32)(out - start);
+
+	fwrite(&header, sizeof(header), 1, m_fp);
+	if (header.payloadSize) fwrite(start, header.payloadSize, 1, m_fp);
+	AtomicStore(&m_bytesWritten, m_bytesWritten + sizeof(header) + header.payloadSize);
+}
@@ -0,0 +1,78 @@
+/// \file TrajectoryRecorder.h
+///
+/// \brief Record the pose of every actor per simulation step to a compact trajectory file.
+///
+
+#ifndef TRAJECTORYRECORDER_H
+#define TRAJECTORYRECORDER_H
+
+#include "NxPhysics.h"
+#include "Trajectory.h"
+#include "Thread.h"
+#include <stdio.h>
+
+///
+/// Records trajectories with the encoding done off the simulation thread.
+///
+/// RecordFrame only copies the actor poses into a free slot of a small ring; a background
+/// thread quantizes, delta encodes and writes the frames. The simulation thread waits only if
+/// all slots are still queued, which is counted in GetNbStalls().
+///
+class TrajectoryRecorder
+{
+public:
+	TrajectoryRecorder();
+	~TrajectoryRecorder();
+
+	/// Start recording to a file. positionScale is the number of quanta per metre.
+	bool Start(const char* filename, NxReal positionScale = 1024.0f, NxU32 keyframeInterval = 60, NxU32 nbSlots = 8);
+
+	/// Flush the queued frames and close the file.
+	void Stop();
+
+	bool IsRecording() const { return m_thread != 0; }
+
+	/// Copy the poses of all actors of the scene. Call after fetchResults.
+	void RecordFrame(NxScene& scene);
+
+	NxU32 GetNbFrames() const { return AtomicLoad(&m_nbFrames); }
+	NxU32 GetNbStalls() const { return m_nbStalls; }
+	NxU32 GetBytesWritten() const { return AtomicLoad(&m_bytesWritten); }
+
+private:
+	TrajectoryRecorder(const TrajectoryRecorder&);
+	TrajectoryRecorder& operator=(const TrajectoryRecorder&);
+
+	static void WriterThread(void* param);
+	void EncodeFrame(NxU32 slot);
+
+	struct FrameSlot
+	{
+		NxU32 frameIndex;
+		NxArray<TrajectoryPose> poses;
+	};
+
+	FILE* m_fp;
+	NxReal m_positionScale;
+	NxU32 m_keyframeInterval;
+
+	NxArray<FrameSlot> m_slots;
+	Semaphore* m_freeSlots;
+	Semaphore* m_filledSlots;
+	void* m_thread;
+	volatile NxU32 m_stop;
+
+	//simulation thread
+	NxU32 m_writeSlot;
+	volatile NxU32 m_nbFrames;
+	NxU32 m_nbStalls;
+
+	//writer thread
+	NxU32 m_readSlot;
+	NxU32 m_nbEncoded;
+	NxArray<NxI32> m_previous;
+	NxArray<NxU8> m_payload;
+	volatile NxU32 m_bytesWritten;
+};
+
+#endif // TRAJECTORYRECORDER_H
@@ -0,0 +1,67 @@
+#include "NxPhysics.h"
+#include "TriggerReport.h"
+#include "UserData.h"
+
+TriggerReport::TriggerReport(NxU32 capacity) : m_nbDropped(0), m_eventMask(NX_TRIGGER_ON_ENTER | NX_TRIGGER_ON_LEAVE)
+{
+	for (NxU32 i = 0; i < TRIGGER_NB_EVENT_TYPES; i++)
+	{
+		m_events[i].resize(capacity ? capacity : 1);
+		m_nbEvents[i] = 0;
+	}
+}
+
+void TriggerReport::Attach(NxScene& scene, NxU32 eventMask)
+{
+	m_eventMask = eventMask;
+	Clear();
+	scene.setUserTriggerReport(this);
+}
+
+void TriggerReport::Clear()
+{
+	for (NxU32 i = 0; i < TRIGGER_NB_EVENT_TYPES; i++)
+		m_nbEvents[i] = 0;
+	m_nbDropped = 0;
+}
+
+void TriggerReport::onTrigger(NxShape& triggerShape, NxShape& otherShape, NxTriggerFlag status)
+{
+	ActorUserData* ud = (ActorUserData*)otherShape.getActor().userData;
+
+	if (status & NX_TRIGGER_ON_ENTER)
+	{
+		if (ud)
+		{
+			ud->nbTriggers++;
+			ud->flags |= UD_IS_INSIDE_TRIGGER;
+		}
+		if (m_eventMask & NX_TRIGGER_ON_ENTER)
+			AddEvent(TRIGGER_ENTER, triggerShape, otherShape);
+	}
+	if (status & NX_TRIGGER_ON_STAY)
+	{
+		if (m_eventMask & NX_TRIGGER_ON_STAY)
+			AddEvent(TRIGGER_STAY, triggerShape, otherShape);
+	}
+	if (status & NX_TRIGGER_ON_LEAVE)
+	{
+		if (ud && ud->nbTriggers && !--ud->nbTriggers)
+			ud->flags &= ~UD_IS_INSIDE_TRIGGER;
+		if (m_eventMask & NX_TRIGGER_ON_LEAVE)
+			AddEvent(TRIGGER_LEAVE, triggerShape, otherShape);
+	}
+}
+
+void TriggerReport::AddEvent(TriggerEventType type, NxShape& triggerShape, NxShape& otherShape)
+{
+	if (m_nbEvents[type] == m_events[type].size())
+	{
+		m_nbDropped++;
+		return;
+	}
+
+	TriggerEvent& event = m_events[type][m_nbEvents[type]++];
+	event.triggerShape = &triggerShape;
+	event.otherShape = &otherShape;
+}
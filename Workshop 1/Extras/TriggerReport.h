@@ -0,0 +1,67 @@
+/// \file TriggerReport.h
+///
+/// \brief Trigger notifications collected into per-frame buffers, with actor occupancy.
+///
+
+#ifndef TRIGGERREPORT_H
+#define TRIGGERREPORT_H
+
+#include "NxPhysics.h"
+
+///
+/// One trigger notification.
+///
+struct TriggerEvent
+{
+	NxShape* triggerShape;
+	NxShape* otherShape;
+};
+
+enum TriggerEventType
+{
+	TRIGGER_ENTER,
+	TRIGGER_STAY,
+	TRIGGER_LEAVE,
+	TRIGGER_NB_EVENT_TYPES,
+};
+
+///
+/// Trigger report that buffers the enter, stay and leave events of a step separately.
+///
+/// Every enter and leave also updates the occupancy of the other shape's actor: the number of
+/// trigger volumes it's inside is kept in ActorUserData::nbTriggers and UD_IS_INSIDE_TRIGGER is
+/// set while it's not zero. The cost is per event, not per actor or per trigger. The occupancy is
+/// updated even if the event isn't buffered, because it was filtered out or the buffer was full.
+/// Events are added during fetchResults; read them afterwards and call Clear before the next fetchResults.
+///
+class TriggerReport : public NxUserTriggerReport
+{
+public:
+	TriggerReport(NxU32 capacity = 1024);
+
+	/// Register with the scene. The mask selects the buffered events, a combination of NX_TRIGGER_ON_*.
+	void Attach(NxScene& scene, NxU32 eventMask = NX_TRIGGER_ON_ENTER | NX_TRIGGER_ON_LEAVE);
+
+	void SetEventMask(NxU32 eventMask) { m_eventMask = eventMask; }
+	NxU32 GetEventMask() const { return m_eventMask; }
+
+	virtual void onTrigger(NxShape& triggerShape, NxShape& otherShape, NxTriggerFlag status);
+
+	NxU32 GetNbEvents(TriggerEventType type) const { return m_nbEvents[type]; }
+	const TriggerEvent* GetEvents(TriggerEventType type) const { return m_nbEvents[type] ? &m_events[type][0] : 0; }
+
+	/// Events dropped because a buffer was full, since the last Clear.
+	NxU32 GetNbDropped() const { return m_nbDropped; }
+
+	void Clear();
+
+private:
+	void AddEvent(TriggerEventType type, NxShape& triggerShape, NxShape& otherShape);
+
+	NxArray<TriggerEvent> m_events[TRIGGER_NB_EVENT_TYPES];
+	NxU32 m_nbEvents[TRIGGER_NB_EVENT_TYPES];
+	NxU32 m_nbDropped;
+	NxU32 m_eventMask;
+};
+
+#endif // TRIGGERREPORT_H
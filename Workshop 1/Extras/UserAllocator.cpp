@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "NxPhysics.h"
+#include "UserAllocator.h"
+
+// Block sizes of the pools, in bytes excluding the header
+static const NxU32 gSizeClasses[UserAllocator::NB_SIZE_CLASSES] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024 };
+static const NxU32 PAGE_SIZE = 64*1024;
+static const NxU16 LARGE_BLOCK = 0xffff;
+static const NxU32 BLOCK_MAGIC = 0x4b4c4255;	//"UBLK"
+
+// Stored in front of every block handed out, keeps the user memory 8 byte aligned
+struct BlockHeader
+{
+	NxU32 size;
+	NxU16 sizeClass;
+	NxU16 tag;
+	NxU32 magic;
+	NxU32 pad;
+};
+
+static BlockHeader* GetHeader(void* memory)
+{
+	return (BlockHeader*)memory - 1;
+}
+
+static NxU32 GetSizeClass(size_t size)
+{
+	for (NxU32 i = 0; i < UserAllocator::NB_SIZE_CLASSES; i++)
+		if (size <= gSizeClasses[i]) return i;
+	return LARGE_BLOCK;
+}
+
+static NxU32 GetTag(NxMemoryType type)
+{
+	return (NxU32)type < UserAllocator::NB_TAGS ? (NxU32)type : UserAllocator::NB_TAGS - 1;
+}
+
+UserAllocator::UserAllocator() : m_nbPoolAllocations(0), m_nbHeapAllocations(0)
+{
+	memset(m_freeLists, 0, sizeof(m_freeLists));
+	memset(m_tags, 0, sizeof(m_tags));
+	memset(&m_total, 0, sizeof(m_total));
+}
+
+UserAllocator::~UserAllocator()
+{
+	for (NxU32 i = 0; i < m_pages.size(); i++)
+		::free(m_pages[i]);
+}
+
+void* UserAllocator::mallocDEBUG(size_t size, const char* fileName, int line)
+{
+	return Allocate(size, NB_TAGS);
+}
+
+void* UserAllocator::mallocDEBUG(size_t size, const char* fileName, int line, const char* className, NxMemoryType type)
+{
+	return Allocate(size, GetTag(type));
+}
+
+void* UserAllocator::malloc(size_t size)
+{
+	return Allocate(size, NB_TAGS);
+}
+
+void* UserAllocator::malloc(size_t size, NxMemoryType type)
+{
+	return Allocate(size, GetTag(type));
+}
+
+void* UserAllocator::Allocate(size_t size, NxU32 tag)
+{
+	NxU32 sizeClass = GetSizeClass(size);
+	BlockHeader* header;
+
+	ScopedLock lock(m_mutex);
+	if (sizeClass == LARGE_BLOCK)
+	{
+		header = (BlockHeader*)::malloc(sizeof(BlockHeader) + size);
+		if (!header) return NULL;
+		m_nbHeapAllocations++;
+	}
+	else
+	{
+		if (!m_freeLists[sizeClass])
+		{
+			//carve a new page into blocks of this class
+			NxU8* page = (NxU8*)::malloc(PAGE_SIZE);
+			if (!page) return NULL;
+			m_pages.pushBack(page);
+			m_nbHeapAllocations++;
+
+			NxU32 stride = sizeof(BlockHeader) + gSizeClasses[sizeClass];
+			for (NxU32 offset = 0; offset + stride <= PAGE_SIZE; offset += stride)
+			{
+				FreeBlock* block = (FreeBlock*)(page + offset);
+				block->next = m_freeLists[sizeClass];
+				m_freeLists[sizeClass] = block;
+			}
+		}
+		header = (BlockHeader*)m_freeLists[sizeClass];
+		m_freeLists[sizeClass] = m_freeLists[sizeClass]->next;
+		m_nbPoolAllocations++;
+	}
+
+	header->size = (NxU32)size;
+	header->sizeClass = (NxU16)sizeClass;
+	header->tag = (NxU16)tag;
+	header->magic = BLOCK_MAGIC;
+	Track(tag, (NxI32)size, 1);
+	return header + 1;
+}
+
+void* UserAllocator::realloc(void* memory, size_t size)
+{
+	if (!memory) return malloc(size);
+	if (!size)
+	{
+		free(memory);
+		return NULL;
+	}
+
+	BlockHeader* header = GetHeader(memory);
+	NX_ASSERT(header->magic == BLOCK_MAGIC);
+
+	//shrinking or growing within the size class keeps the block
+	if (header->sizeClass != LARGE_BLOCK && size <= gSizeClasses[header->sizeClass])
+	{
+		ScopedLock lock(m_mutex);
+		Track(header->tag, (NxI32)size - (NxI32)header->size, 0);
+		header->size = (NxU32)size;
+		return memory;
+	}
+
+	void* newMemory = Allocate(size, header->tag);
+	if (!newMemory) return NULL;
+	memcpy(newMemory, memory, header->size < size ? header->size : size);
+	free(memory);
+	return newMemory;
+}
+
+void UserAllocator::free(void* memory)
+{
+	if (!memory) return;
+
+	BlockHeader* header = GetHeader(memory);
+	NX_ASSERT(header->magic == BLOCK_MAGIC);
+	header->magic = 0;
+
+	ScopedLock lock(m_mutex);
+	Track(header->tag, -(NxI32)header->size, -1);
+	if (header->sizeClass == LARGE_BLOCK)
+	{
+		::free(header);
+	}
+	else
+	{
+		//the link overwrites the header
+		NxU32 sizeClass = header->sizeClass;
+		FreeBlock* block = (FreeBlock*)header;
+		block->next = m_freeLists[sizeClass];
+		m_freeLists[sizeClass] = block;
+	}
+}
+
+void UserAllocator::Track(NxU32 tag, NxI32 bytes, NxI32 blocks)
+{
+	AllocatorStats* stats[2] = { &m_tags[tag], &m_total };
+	for (NxU32 i = 0; i < 2; i++)
+	{
+		stats[i]->currentBytes += bytes;
+		stats[i]->nbLive += blocks;
+		if (blocks > 0) stats[i]->nbAllocations++;
+		if (stats[i]->currentBytes > stats[i]->peakBytes) stats[i]->peakBytes = stats[i]->currentBytes;
+	}
+}
+
+AllocatorStats UserAllocator::GetStats() const
+{
+	ScopedLock lock(m_mutex);
+	return m_total;
+}
+
+AllocatorStats UserAllocator::GetStats(NxU32 tag) const
+{
+	ScopedLock lock(m_mutex);
+	return m_tags[tag < NB_TAGS ? tag : NB_TAGS];
+}
+
+void UserAllocator::ResetPeaks()
+{
+	ScopedLock lock(m_mutex);
+	for (NxU32 i = 0; i <= NB_TAGS; i++)
+		m_tags[i].peakBytes = m_tags[i].currentBytes;
+	m_total.peakBytes = m_total.currentBytes;
+}
+
+void UserAllocator::PrintStats() const
+{
+	ScopedLock lock(m_mutex);
+	printf("Memory: %u bytes in %u blocks, peak %u bytes, %u allocations (%u pooled, %u from the heap)\n",
+		m_total.currentBytes, m_total.nbLive, m_total.peakBytes, m_total.nbAllocations, m_nbPoolAllocations, m_nbHeapAllocations);
+	for (NxU32 i = 0; i <= NB_TAGS; i++)
+	{
+		const AllocatorStats& stats = m_tags[i];
+		if (!stats.nbAllocations) continue;
+		if (i == NB_TAGS)
+			printf("  untagged  ");
+		else
+			printf("  type %-4u ", i);
+		printf("%10u bytes %8u blocks, peak %10u bytes, %8u allocations\n", stats.currentBytes, stats.nbLive, stats.peakBytes, stats.nbAllocations);
+	}
+}
@@ -0,0 +1,88 @@
+/// \file UserAllocator.h
+///
+/// \brief PhysX allocator with pooled small blocks and per memory type statistics.
+///
+
+#ifndef USERALLOCATOR_H
+#define USERALLOCATOR_H
+
+#include "NxPhysics.h"
+#include "Thread.h"
+
+///
+/// Allocation counters for one memory type or for all of them.
+///
+struct AllocatorStats
+{
+	NxU32 nbLive;			//blocks currently allocated
+	NxU32 nbAllocations;	//blocks allocated since creation, including reallocations
+	NxU32 currentBytes;
+	NxU32 peakBytes;
+};
+
+///
+/// Allocator to pass to NxCreatePhysicsSDK.
+///
+/// Blocks up to 1KB are carved from 64KB pages into per size class free lists, so the frequent
+/// small allocations of actor creation don't go to the heap. Larger blocks go straight to
+/// malloc. Every block carries a small header with its size class and memory type, which is
+/// used to keep the statistics per NxMemoryType tag. Pages are only returned to the heap when
+/// the allocator is destroyed, so it has to outlive the SDK.
+///
+class UserAllocator : public NxUserAllocator
+{
+public:
+	UserAllocator();
+	virtual ~UserAllocator();
+
+	virtual void* mallocDEBUG(size_t size, const char* fileName, int line);
+	virtual void* mallocDEBUG(size_t size, const char* fileName, int line, const char* className, NxMemoryType type);
+	virtual void* malloc(size_t size);
+	virtual void* malloc(size_t size, NxMemoryType type);
+	virtual void* realloc(void* memory, size_t size);
+	virtual void free(void* memory);
+
+	/// Statistics of all blocks.
+	AllocatorStats GetStats() const;
+
+	/// Statistics of one memory type; untagged allocations are reported as NB_TAGS.
+	AllocatorStats GetStats(NxU32 tag) const;
+
+	/// Number of blocks served from the pools and from the heap.
+	NxU32 GetNbPoolAllocations() const { return m_nbPoolAllocations; }
+	NxU32 GetNbHeapAllocations() const { return m_nbHeapAllocations; }
+
+	/// Start measuring the peaks again from the current usage.
+	void ResetPeaks();
+
+	/// Print the totals and the statistics of every memory type used so far.
+	void PrintStats() const;
+
+	enum
+	{
+		NB_TAGS = 64,
+		NB_SIZE_CLASSES = 12,
+	};
+
+private:
+	UserAllocator(const UserAllocator&);
+	UserAllocator& operator=(const UserAllocator&);
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	void* Allocate(size_t size, NxU32 tag);
+	void Track(NxU32 tag, NxI32 bytes, NxI32 blocks);
+
+	mutable Mutex m_mutex;
+	FreeBlock* m_freeLists[NB_SIZE_CLASSES];
+	NxArray<void*> m_pages;
+	AllocatorStats m_tags[NB_TAGS + 1];
+	AllocatorStats m_total;
+	NxU32 m_nbPoolAllocations;
+	NxU32 m_nbHeapAllocations;
+};
+
+#endif // USERALLOCATOR_H
@@ -5,8 +5,88 @@
 //						    Written by Bob Schade, 5-1-06
 // ===============================================================================
 
+#include <stdio.h>
 #include "UserData.h"
 
+// All user data comes from pools, so attaching it to many actors costs few heap allocations
+static Pool<ActorUserData> gActorUserData;
+static Pool<ShapeUserData> gShapeUserData;
+// Mesh descriptors are saved once per mesh and shared by its shapes
+static MeshRegistry gMeshRegistry;
+
+// Shape ids and the sidecar tables indexed by them
+static NxU32 gNbShapeIds = 0;
+static NxArray<NxU32> gFreeShapeIds;
+static NxArray<MeshRecord*> gShapeMeshes;
+static NxArray<WheelShapeData*> gShapeWheels;
+static Pool<WheelShapeData> gWheelShapeData(64);
+// Not pooled: Pool::Reset doesn't run destructors and the arrays own their memory
+static NxArray<HeightFieldData*> gShapeHeightFields;
+
+static NxU32 AllocateShapeId()
+{
+	if (gFreeShapeIds.size())
+	{
+		NxU32 id = gFreeShapeIds.back();
+		gFreeShapeIds.popBack();
+		return id;
+	}
+	gShapeMeshes.pushBack(0);
+	gShapeWheels.pushBack(0);
+	gShapeHeightFields.pushBack(0);
+	return gNbShapeIds++;
+}
+
+MeshRecord* GetShapeMesh(const ShapeUserData* sud)
+{
+	return sud ? gShapeMeshes[sud->id] : NULL;
+}
+
+void* GetShapeMeshDesc(const ShapeUserData* sud)
+{
+	MeshRecord* record = GetShapeMesh(sud);
+	return record ? record->desc : NULL;
+}
+
+WheelShapeData* GetWheelShapeData(const ShapeUserData* sud)
+{
+	return sud ? gShapeWheels[sud->id] : NULL;
+}
+
+HeightFieldData* GetHeightFieldData(const ShapeUserData* sud)
+{
+	return sud ? gShapeHeightFields[sud->id] : NULL;
+}
+
+static HeightFieldData* CreateHeightFieldData(const NxHeightFieldShape& hfs)
+{
+	HeightFieldData* data = new HeightFieldData;
+	const NxHeightField& hf = hfs.getHeightField();
+	for (NxU32 row = 0; row < hf.getNbRows() - 1; row++)
+	{
+		for (NxU32 column = 0; column < hf.getNbColumns() - 1; column++)
+		{
+			//two triangles per cell
+			NxU32 triangleIndex = 2 * (row * hf.getNbColumns() + column);
+			for (NxU32 i = 0; i < 2; i++)
+			{
+				NxTriangle tri;
+				if (!hfs.getTriangle(tri, NULL, NULL, triangleIndex + i, false))
+					continue;	//hole
+
+				NxVec3 n = (tri.verts[1] - tri.verts[0]).cross(tri.verts[2] - tri.verts[0]);
+				n.normalize();
+				for (NxU32 j = 0; j < 3; j++)
+				{
+					data->vertices.pushBack(tri.verts[j]);
+					data->normals.pushBack(n);
+				}
+			}
+		}
+	}
+	return data;
+}
+
 void AddUserDataToActors(NxScene* scene)
 {
     NxU32 i = 0;
@@ -14,45 +94,48 @@ void AddUserDataToActors(NxScene* scene)
 	NxActor** actors = scene->getActors();
 	NxU32 nbActors = scene->getNbActors();
 	while (nbActors--)
-	{
-		NxActor* actor = actors[nbActors];
-        actor->userData = new ActorUserData;
-		((ActorUserData *)(actor->userData))->id = i++;
-		// FIXME: After setting it, actorDesc.managedHwSceneIndex gets cleared for some reason...
+		AddUserDataToActor(actors[nbActors], i++);
+}
+
+void AddUserDataToActor(NxActor* actor, NxU32 id)
+{
+    actor->userData = gActorUserData.Allocate();
+	((ActorUserData *)(actor->userData))->id = id;
+	// FIXME: After setting it, actorDesc.managedHwSceneIndex gets cleared for some reason...
 #if 0
-		NxActorDesc actorDesc;
-		actor->saveToDesc(actorDesc);
-		if (actorDesc.managedHwSceneIndex > 0)  
-		{
-			// To identify the actor when render it, set a bit in the userdata flags
-			((ActorUserData *)(actor->userData))->flags |= UD_IS_HW_ACTOR;
-		}
-#endif
-        AddUserDataToShapes(actor);
+	NxActorDesc actorDesc;
+	actor->saveToDesc(actorDesc);
+	if (actorDesc.managedHwSceneIndex > 0)  
+	{
+		// To identify the actor when render it, set a bit in the userdata flags
+		((ActorUserData *)(actor->userData))->flags |= UD_IS_HW_ACTOR;
 	}
+#endif
+    AddUserDataToShapes(actor);
 }
 
 void AddUserDataToShapes(NxActor* actor)
 {
-    NxU32 i = 0;
-
 	NxShape*const* shapes = actor->getShapes();
 	NxU32 nbShapes = actor->getNbShapes();
 	while (nbShapes--)
 	{
 		NxShape* shape = shapes[nbShapes];
-        shape->userData = new ShapeUserData;
+        shape->userData = gShapeUserData.Allocate();
 		ShapeUserData* sud = (ShapeUserData*)(shape->userData);
-		sud->id = i++;
-		if (shape->getType() == NX_SHAPE_CONVEX)
-		{
-			sud->mesh = new NxConvexMeshDesc;
-			shape->isConvexMesh()->getConvexMesh().saveToDesc(*(NxConvexMeshDesc*)sud->mesh);
-		}
-		if (shape->getType() == NX_SHAPE_MESH)
+		sud->id = AllocateShapeId();
+		gShapeMeshes[sud->id] = gMeshRegistry.Acquire(*shape);
+		if (shape->getType() == NX_SHAPE_WHEEL)
+			gShapeWheels[sud->id] = gWheelShapeData.Allocate();
+		else if (shape->getType() == NX_SHAPE_HEIGHTFIELD)
+			gShapeHeightFields[sud->id] = CreateHeightFieldData(*shape->isHeightField());
+
+		//mark trigger volumes and the actors that own them
+		if (shape->getFlag(NX_TRIGGER_ENABLE))
 		{
-			sud->mesh = new NxTriangleMeshDesc;
-			shape->isTriangleMesh()->getTriangleMesh().saveToDesc(*(NxTriangleMeshDesc*)sud->mesh);
+			sud->flags |= UD_IS_TRIGGER;
+			if (actor->userData)
+				((ActorUserData*)actor->userData)->flags |= UD_IS_TRIGGER;
 		}
 	}
 }
@@ -62,15 +145,17 @@ void ReleaseUserDataFromActors(NxScene* scene)
 	NxActor** actors = scene->getActors();
 	NxU32 nbActors = scene->getNbActors();
 	while (nbActors--)
+		ReleaseUserDataFromActor(actors[nbActors]);
+}
+
+void ReleaseUserDataFromActor(NxActor* actor)
+{
+	if (actor->userData) 
 	{
-		NxActor* actor = actors[nbActors];
-		if (actor->userData) 
-		{
-			delete actor->userData;
-			actor->userData = 0;
-		}
-        ReleaseUserDataFromShapes(actor);
+		gActorUserData.Release((ActorUserData*)actor->userData);
+		actor->userData = 0;
 	}
+    ReleaseUserDataFromShapes(actor);
 }
 
 void ReleaseUserDataFromShapes(NxActor* actor)
@@ -83,15 +168,59 @@ void ReleaseUserDataFromShapes(NxActor* actor)
         if (shape->userData)
 		{
 		    ShapeUserData* sud = (ShapeUserData*)(shape->userData);
-			if (sud && sud->mesh)
-			{
-			    delete sud->mesh;
-				sud->mesh = 0;
-		    }
+			gMeshRegistry.Release(gShapeMeshes[sud->id]);
+			gWheelShapeData.Release(gShapeWheels[sud->id]);
+			delete gShapeHeightFields[sud->id];
+			gShapeMeshes[sud->id] = 0;
+			gShapeWheels[sud->id] = 0;
+			gShapeHeightFields[sud->id] = 0;
+			gFreeShapeIds.pushBack(sud->id);
 		}
-		delete shape->userData;
+		gShapeUserData.Release((ShapeUserData*)shape->userData);
 		shape->userData = 0;
 	}
 }
 
+void ResetUserData()
+{
+	gActorUserData.Reset();
+	gShapeUserData.Reset();
+	gMeshRegistry.Reset();
+	gWheelShapeData.Reset();
+	for (NxU32 i = 0; i < gShapeHeightFields.size(); i++)
+		delete gShapeHeightFields[i];
+	gNbShapeIds = 0;
+	gFreeShapeIds.clear();
+	gShapeMeshes.clear();
+	gShapeWheels.clear();
+	gShapeHeightFields.clear();
+}
+
+void GetUserDataStats(UserDataStats& stats)
+{
+	stats.actors = gActorUserData.GetStats();
+	stats.shapes = gShapeUserData.GetStats();
+	stats.wheels = gWheelShapeData.GetStats();
+	stats.convexDescs = gMeshRegistry.GetConvexDescStats();
+	stats.triangleMeshDescs = gMeshRegistry.GetTriangleMeshDescStats();
+	stats.nbMeshes = gMeshRegistry.GetNbMeshes();
+	stats.nbMeshReferences = gMeshRegistry.GetNbReferences();
+}
 
+static void PrintPoolStats(const char* name, const PoolStats& stats)
+{
+	printf("%-20s live %u, peak %u, allocations %u, heap blocks %u (%u bytes)\n", name,
+		stats.nbLive, stats.nbPeak, stats.nbAllocations, stats.nbBlocks, stats.nbBytes);
+}
+
+void PrintUserDataStats()
+{
+	UserDataStats stats;
+	GetUserDataStats(stats);
+	PrintPoolStats("ActorUserData", stats.actors);
+	PrintPoolStats("ShapeUserData", stats.shapes);
+	PrintPoolStats("WheelShapeData", stats.wheels);
+	PrintPoolStats("NxConvexMeshDesc", stats.convexDescs);
+	PrintPoolStats("NxTriangleMeshDesc", stats.triangleMeshDescs);
+	printf("%u unique meshes shared by %u shapes\n", stats.nbMeshes, stats.nbMeshReferences);
+}
@@ -9,6 +9,9 @@
 #define USERDATA_H
 
 #include "NxPhysics.h"
+#include "Pool.h"
+#include "MeshRegistry.h"
+#include "ActorHandles.h"
 
 enum UserDataFlag
 {
@@ -23,47 +26,102 @@ enum UserDataFlag
 	UD_RENDER_USING_LIGHT1			= (1<<8),
 };
 
+// Kept up to date by TriggerReport, SceneQueryService and SleepNotify, not part of a saved state
+static const NxU32 UD_RUNTIME_FLAGS = UD_IS_INSIDE_TRIGGER | UD_PASSES_INTERSECTION_TEST | UD_HIT_BY_RAYCAST | UD_IS_ASLEEP;
+
 
 void AddUserDataToActors(NxScene* scene);
+void AddUserDataToActor(NxActor* actor, NxU32 id);	//actor and shapes
 void AddUserDataToShapes(NxActor* actor);
 
 void ReleaseUserDataFromActors(NxScene* scene);
+void ReleaseUserDataFromActor(NxActor* actor);		//actor and shapes
 void ReleaseUserDataFromShapes(NxActor* actor);
 
+// Release all user data at once, e.g. before the scene is released; doesn't touch the actors
+void ResetUserData();
+
+struct UserDataStats
+{
+	PoolStats actors;
+	PoolStats shapes;
+	PoolStats wheels;
+	PoolStats convexDescs;
+	PoolStats triangleMeshDescs;
+	NxU32 nbMeshes;				//unique meshes with a saved descriptor
+	NxU32 nbMeshReferences;		//shapes using them
+};
+
+void GetUserDataStats(UserDataStats& stats);
+void PrintUserDataStats();
+
+static const NxU32 INVALID_AWAKE_INDEX = 0xffffffff;
+
 class ActorUserData
 {
 public:
 	NxU32 id;
 	NxU32 contactEvents;
 	NxU32 flags;
+	NxU32 nbTriggers;		//trigger volumes the actor is inside, see TriggerReport
+	NxU32 awakeIndex;		//position in the awake set of SleepNotify
+	ActorHandle handle;		//set by ActorHandleTable
 
 	ActorUserData()
 	{
 		id = 0;
 		contactEvents = 0;
 		flags = 0;
+		nbTriggers = 0;
+		awakeIndex = INVALID_AWAKE_INDEX;
 	}
 };
 
+static const NxU32 INVALID_RENDER_HANDLE = 0xffffffff;
+
+// Only the fields used for every shape, each frame; the rest is kept in tables indexed by id
 class ShapeUserData
 {
 public:
-	NxU32 id;
-	void* mesh;
-    void* model;
-
-	NxReal wheelShapeRollAngle;
-	NxMat34 wheelShapePose;
+	NxU32 id;				//unique among the shapes with user data, reused after release
+	NxU32 flags;			//UserDataFlag
+	NxU32 renderHandle;
 
 	ShapeUserData()
 	{
 		id = 0;
-		mesh = NULL;
-        model = NULL;
-		wheelShapeRollAngle = 0;
-//		wheelShapePose = 0;
+		flags = 0;
+		renderHandle = INVALID_RENDER_HANDLE;
 	}
 };
 
+class WheelShapeData
+{
+public:
+	NxReal rollAngle;
+	NxMat34 pose;
+
+	WheelShapeData()
+	{
+		rollAngle = 0;
+		pose.id();
+	}
+};
+
+// Heightfield triangles in shape space, saved when the user data is added; later edits of the
+// heightfield are not reflected
+class HeightFieldData
+{
+public:
+	NxArray<NxVec3> vertices;	//three per triangle
+	NxArray<NxVec3> normals;	//one per vertex
+};
+
+// Sidecar data of a shape, NULL if the shape has none
+MeshRecord* GetShapeMesh(const ShapeUserData* sud);
+void* GetShapeMeshDesc(const ShapeUserData* sud);	//NxConvexMeshDesc or NxTriangleMeshDesc
+WheelShapeData* GetWheelShapeData(const ShapeUserData* sud);
+HeightFieldData* GetHeightFieldData(const ShapeUserData* sud);
+
 #endif  // USERDATA_H
 
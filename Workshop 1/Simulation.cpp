@@ -1,19 +1,37 @@
 #include "Simulation.h"
 #include "Extras/Timing.h"
+#include "Extras/Stream.h"
+#include "Extras/ReadAheadStream.h"
+#include "Extras/SceneSnapshot.h"
+#include "Extras/UserData.h"
+#include "Extras/UserAllocator.h"
+#include "Extras/ContactReport.h"
+#include "Extras/TriggerReport.h"
+#include "Extras/SceneQueryService.h"
+#include "Extras/SleepNotify.h"
+#include "Extras/ActorHandles.h"
+#include "Extras/Options.h"
 #include <stdio.h>
 
 //global variables
 NxPhysicsSDK* physx = 0;
 NxScene* scene = 0;
 NxReal delta_time;
+UserAllocator gAllocator;	//all SDK memory goes through it, must outlive the SDK
+ContactReport gContactReport;	//contacts of the last step, read in UpdateScene
+TriggerReport gTriggerReport;	//trigger events of the last step, read in UpdateScene
+SceneQueryService gSceneQueries;	//queries added in UpdateScene, run before the next step
+SleepNotify gSleepNotify;	//awake actors and UD_IS_ASLEEP
+ActorHandleTable gActorHandles;	//handles stay safe to use after the scene is reset
+Options gOptions;	//command line settings, parsed in Init
 
 //actors
-NxActor* groundPlane = 0;
-NxActor* box = 0;
+ActorHandle groundPlane;
+ActorHandle box;
 
 //user function declarations
 NxActor* CreateGroundPlane();
-NxActor* CreateBox();
+NxActor* CreateBox(const NxVec3& position);
 
 ///
 /// Initialise the SDK, hardware support, debugging parameters, default gravity etc.
@@ -21,7 +39,7 @@ NxActor* CreateBox();
 bool InitPhysX()
 {
 	//initialise the SDK
-	physx = NxCreatePhysicsSDK(NX_PHYSICS_SDK_VERSION);
+	physx = NxCreatePhysicsSDK(NX_PHYSICS_SDK_VERSION, &gAllocator);
 	if (!physx) return false;
 
 	//visual debugging 
@@ -37,6 +55,21 @@ bool InitPhysX()
     NxSceneDesc sceneDesc;
 	sceneDesc.gravity = NxVec3(0,-9.8f,0);	//default gravity
 
+	//the SDK's internal step is the simulation thread's step split into equal substeps, so every
+	//simulate call runs exactly nbSubsteps of them instead of the default 1/60s steps
+	sceneDesc.maxTimestep = gOptions.timeStep/gOptions.nbSubsteps;
+	sceneDesc.maxIter = gOptions.nbSubsteps;
+	sceneDesc.timeStepMethod = NX_TIMESTEP_FIXED;
+
+	//worker threads of the SDK within a step
+	if (gOptions.nbThreads)
+	{
+		sceneDesc.flags |= NX_SF_ENABLE_MULTITHREAD;
+		sceneDesc.internalThreadCount = gOptions.nbThreads;
+	}
+	if (gOptions.nbBackgroundThreads)
+		sceneDesc.backgroundThreadCount = gOptions.nbBackgroundThreads;
+
 	//check the hardware option first
 	sceneDesc.simType = NX_SIMULATION_HW;
     scene = physx->createScene(sceneDesc);	
@@ -49,6 +82,16 @@ bool InitPhysX()
 		if(!scene) return false;
 	}
 
+	//collect contact notifications
+	gContactReport.Attach(*scene, NX_NOTIFY_ON_START_TOUCH | NX_NOTIFY_ON_END_TOUCH);
+
+	//collect trigger notifications, the UD_IS_INSIDE_TRIGGER flags are kept up to date by the report
+	gTriggerReport.Attach(*scene, NX_TRIGGER_ON_ENTER | NX_TRIGGER_ON_LEAVE);
+
+	//batched raycasts, sweeps and overlaps
+	if (!gSceneQueries.Init(*scene))
+		printf("Could not create the scene query object.\n");
+
 	//update the current time
 	getElapsedTime();
 
@@ -60,6 +103,10 @@ bool InitPhysX()
 ///
 void ReleasePhysX()
 {
+	//the user data goes with the scene, no need to detach it actor by actor
+	ResetUserData();
+	gActorHandles.Clear();
+	gSceneQueries.Release();
 	if (scene) physx->releaseScene(*scene);
 	if (physx) physx->release();
 }
@@ -79,10 +126,21 @@ void ResetPhysX()
 ///
 void SimulationStep()
 {
+	// perform a simulation step for delta time since the last frame
+	SimulationStep(getElapsedTime());
+}
+
+///
+/// Start the processing of simulation with a given time step.
+///
+void SimulationStep(NxReal timeStep)
+{
+	// Run the queries added since the last step, the results are read in the next UpdateScene
+	gSceneQueries.Execute();
+
 	// Update the time step
-	delta_time = getElapsedTime();
+	delta_time = timeStep;
 
-	// perform a simulation step for delta time since the last frame
 	scene->simulate(delta_time);
 	scene->flushStream();
 }
@@ -95,14 +153,66 @@ void GetPhysicsResults()
 	scene->fetchResults(NX_RIGID_BODY_FINISHED, true);
 }
 
+///
+/// Write the pose, velocities, sleep state and user flags of all actors. Call between GetPhysicsResults and SimulationStep.
+///
+bool SaveSimulationState(const char* filename)
+{
+	if (!scene) return false;
+
+	SceneSnapshot snapshot;
+	snapshot.Capture(*scene);
+
+	UserStream stream(filename, false);
+	if (!stream.fp) return false;
+	snapshot.Save(stream);
+	return true;
+}
+
+///
+/// Restore a state saved by SaveSimulationState. Call between GetPhysicsResults and SimulationStep.
+///
+bool LoadSimulationState(const char* filename)
+{
+	if (!scene) return false;
+
+	SceneSnapshot snapshot;
+	{
+		ReadAheadStream stream(filename);
+		if (!stream.IsOpen() || !snapshot.Load(stream, scene->getNbActors())) return false;
+	}
+	if (!snapshot.Restore(*scene)) return false;
+
+	//the sleep states were changed directly
+	gSleepNotify.Rebuild(*scene);
+	return true;
+}
+
 ///
 /// Initialise all actors and their properties here.
 ///
 void InitScene()
 {
 	//init actors
-	groundPlane = CreateGroundPlane();
-	box = CreateBox();
+	NxActor* groundPlaneActor = CreateGroundPlane();
+
+	//the first box falls from 3.5m, more boxes are stacked in a 5x5 grid of columns around it
+	NxActor* boxActor = 0;
+	for (NxU32 i = 0; i < gOptions.nbActors; i++)
+	{
+		NxReal x = (NxReal)((i%5 + 2)%5) - 2;
+		NxReal z = (NxReal)((i/5%5 + 2)%5) - 2;
+		NxReal y = 3.5f + (i/25)*1.5f;
+		NxActor* actor = CreateBox(NxVec3(x*1.5f, y, z*1.5f));
+		if (!boxActor) boxActor = actor;
+	}
+
+	//refer to the actors through handles from now on
+	groundPlane = groundPlaneActor ? gActorHandles.GetHandle(*groundPlaneActor) : ActorHandle();
+	box = boxActor ? gActorHandles.GetHandle(*boxActor) : ActorHandle();
+
+	//track the awake actors from now on
+	gSleepNotify.Attach(*scene);
 }
 
 ///
@@ -110,6 +220,55 @@ void InitScene()
 ///
 void UpdateScene()
 {
+	//react to the contacts of the last step, here just keep the latest events of every actor
+	const ContactEvent* events = gContactReport.GetEvents();
+	NxU32 nbEvents = gContactReport.GetNbEvents();
+	for (NxU32 i = 0; i < nbEvents; i++)
+	{
+		for (NxU32 j = 0; j < 2; j++)
+		{
+			NxActor* actor = events[i].actors[j];
+			if (actor && actor->userData)
+				((ActorUserData*)actor->userData)->contactEvents = events[i].events;
+		}
+	}
+	gContactReport.Clear();
+
+	//the enter/leave events of the last step are available here through gTriggerReport.GetEvents
+	gTriggerReport.Clear();
+
+	//the results of the queries added in the last UpdateScene are available here through gSceneQueries,
+	//new ones are added with gSceneQueries.AddRaycast/AddSweep/AddOverlap
+}
+
+///
+/// Create an actor, attach the user data (ids and render flags) to it and its shapes and register
+/// it, so it can be referred to by handle and is tracked by the sleep notifications.
+///
+NxActor* CreateActor(const NxActorDesc& actorDesc)
+{
+	NxActor* actor = scene->createActor(actorDesc);
+	if (!actor) return 0;
+
+	AddUserDataToActor(actor, scene->getNbActors() - 1);
+	gActorHandles.Add(*actor);
+	gSleepNotify.Track(*actor);
+	return actor;
+}
+
+///
+/// Release an actor: its handle goes stale (selection, bindings), it leaves the awake set and the
+/// query results, then its user data and the actor itself are released.
+///
+void ReleaseActor(NxActor* actor)
+{
+	if (!actor) return;
+
+	gSleepNotify.Remove(*actor);
+	gSceneQueries.RemoveActor(*actor);
+	gActorHandles.Remove(gActorHandles.GetHandle(*actor));
+	ReleaseUserDataFromActor(actor);
+	scene->releaseActor(*actor);
 }
 
 NxActor* CreateGroundPlane()
@@ -118,14 +277,11 @@ NxActor* CreateGroundPlane()
 	NxActorDesc actorDesc;
 	NxPlaneShapeDesc planeDesc;
 	actorDesc.shapes.pushBack(&planeDesc);
-	return scene->createActor(actorDesc);
+	return CreateActor(actorDesc);
 }
 
-NxActor* CreateBox()
+NxActor* CreateBox(const NxVec3& position)
 {
-	// Set the initial height of the box to 3.5m so that it starts off falling onto the ground
-	NxReal boxStartHeight = 3.5; 
-
 	// Actor, body and shape descriptors
 	NxActorDesc actorDesc;
 	NxBodyDesc bodyDesc;
@@ -137,7 +293,7 @@ NxActor* CreateBox()
 
 	actorDesc.body			= &bodyDesc;
 	actorDesc.density		= 10.0f; // kg/m^3
-	actorDesc.globalPose.t	= NxVec3(0, boxStartHeight, 0);	
+	actorDesc.globalPose.t	= position;
 
-	return scene->createActor(actorDesc);	
+	return CreateActor(actorDesc);	
 }
@@ -13,6 +13,12 @@
 /// Initialise the scene.
 void InitScene();
 
+/// Create an actor with its user data, registered with the handle table and the awake set.
+NxActor* CreateActor(const NxActorDesc& actorDesc);
+
+/// Release an actor created with CreateActor and everything that refers to it, call between steps.
+void ReleaseActor(NxActor* actor);
+
 /// User defined routine.
 void UpdateScene();
 
@@ -28,6 +34,15 @@ void ResetPhysX();
 /// Start a single step of simulation.
 void SimulationStep();
 
+/// Start a single step of simulation with a fixed time step.
+void SimulationStep(NxReal timeStep);
+
 /// Collect the simulation results.
 void GetPhysicsResults();
 
+/// Save the state of all actors to a file.
+bool SaveSimulationState(const char* filename);
+
+/// Restore the state of all actors from a file written by SaveSimulationState.
+bool LoadSimulationState(const char* filename);
+
@@ -4,11 +4,29 @@
 #include "Extras/DrawObjects.h"
 #include "Extras/Timing.h"
 #include "Extras/UserData.h"
+#include "Extras/TrajectoryRecorder.h"
+#include "Extras/TrajectoryPlayer.h"
+#include "Extras/UserAllocator.h"
+#include "Extras/ActorHandles.h"
+#include "Extras/InputActions.h"
+#include "Extras/SimulationThread.h"
+#include "Extras/PoseBuffer.h"
+#include "Extras/FrameScheduler.h"
+#include "Extras/SleepNotify.h"
+#include "Extras/ContactReport.h"
+#include "Extras/PerfHUD.h"
+#include "Extras/TraceEvents.h"
+#include "Extras/Options.h"
 #include <GL/glut.h>
 
 //extern variables, defined in Simulation.cpp
 extern NxScene* scene;
 extern NxReal delta_time;
+extern UserAllocator gAllocator;
+extern ActorHandleTable gActorHandles;
+extern SleepNotify gSleepNotify;
+extern ContactReport gContactReport;
+extern Options gOptions;
 
 //global variables
 bool bHardwareScene = false;
@@ -16,9 +34,69 @@ bool bPause = false;
 bool bShadows = true;
 RenderingMode rendering_mode = RENDER_SOLID;
 DebugRenderer gDebugRenderer;
-const NxDebugRenderable* debugRenderable = 0;
-NxActor* gSelectedActor = 0;
+ActorHandle gSelectedActor;
 HUD hud;
+PerfHUD gPerfHUD;
+
+// The simulation runs at a fixed rate on its own thread and hands copies of the actor and shape
+// poses to Display through gPoses. The GLUT thread only touches the scene while that thread is
+// stopped (replay, reset, exit); the requests, input and selection shared with it are guarded by
+// gRequestLock.
+SimulationThread gSimulationThread;
+PoseBuffer gPoses;
+Mutex gRequestLock;
+NxU32 gStepIndex = 0;
+bool bStepRunning = false;	// simulation thread, a step was started and not fetched yet
+bool bCapturePoses = true;	// publish the poses after the next step even if nothing moved
+
+// Frame pacing, frames are only drawn when a new step was published or the view changed
+FrameScheduler gScheduler;
+NxU32 gLastPublished = 0;
+NxReal gFrameTime = 0;	// time of the last rendered frame, moves the camera
+double gLastFrameStart = 0;
+NxU32 gLastSkipped = 0;
+
+// State snapshot requests, handled by the simulation thread between steps
+bool bSaveState = false;
+bool bLoadState = false;
+const char* gStateFile = "snapshot.bin";
+
+// Trajectory recording, started and stopped by the simulation thread
+bool bToggleRecording = false;
+TrajectoryRecorder gRecorder;
+const char* gTrajectoryFile = "trajectory.trj";
+
+// Trajectory replay, the scene is only used for its shapes and isn't simulated
+bool bReplay = false;
+TrajectoryPlayer gPlayer;
+NxReal gReplayFrame = 0;
+NxReal gReplaySpeed = 1;
+const NxU32 gReplaySeekFrames = 60;
+
+// Mouse picking request, the ray is made on the GLUT thread and cast by the simulation thread
+bool bPick = false;
+NxRay gPickRay;
+
+// Trace of the step and frame phases, started and stopped with 't'
+TraceLog gTrace;
+const char* gTraceFile = "trace.json";
+TraceFormat gTraceFormat = TRACE_JSON;
+
+// Start of a run timed with --benchmark
+double gBenchmarkStart = 0;
+
+///
+/// Time a phase for the performance overlay and the trace.
+///
+class PhaseTimer
+{
+public:
+	PhaseTimer(PerfPhase phase) : m_perf(gPerfHUD, phase), m_trace(gTrace, GetPerfPhaseName(phase)) {}
+
+private:
+	PerfTimer m_perf;
+	TraceScope m_trace;
+};
 
 // Force globals
 NxVec3	gForceVec(0,0,0);
@@ -28,6 +106,26 @@ NxReal	gForceStrength	= 20000;
 #define MAX_KEYS 256
 bool gKeys[MAX_KEYS];
 
+// Held key actions, camera axes are (right, world up, forward), force axes are world space
+enum Action
+{
+	ACTION_CAMERA_FORWARD,
+	ACTION_CAMERA_BACK,
+	ACTION_CAMERA_LEFT,
+	ACTION_CAMERA_RIGHT,
+	ACTION_CAMERA_DOWN,
+	ACTION_CAMERA_UP,
+	ACTION_FORCE_POS_Z,
+	ACTION_FORCE_NEG_Z,
+	ACTION_FORCE_POS_X,
+	ACTION_FORCE_NEG_X,
+	ACTION_FORCE_POS_Y,
+	ACTION_FORCE_NEG_Y,
+};
+const NxU32 CAMERA_ACTIONS = 0x03f;
+const NxU32 FORCE_ACTIONS = 0xfc0;
+InputActions gInput;
+
 // Camera globals
 float	gCameraAspectRatio = 1.0f;
 NxVec3	gCameraPos(0,5,-15);
@@ -36,12 +134,60 @@ NxVec3	gCameraRight(-1,0,0);
 const NxReal gCameraSpeed = 10;
 
 ///
-/// Assign callback functions, set-up lighting and initialise HUD.
+/// Read the command line options, create the window and initialise the scene and HUD.
 ///
 void Init(int argc, char** argv)
+{
+	//the options go first, glutInit gets the arguments that are left
+	if (!ParseOptions(argc, argv, gOptions) || gOptions.showHelp)
+	{
+		PrintUsage(argv[0]);
+		exit(gOptions.showHelp ? 0 : 1);
+	}
+	rendering_mode = (RenderingMode)gOptions.renderMode;
+	bShadows = gOptions.shadows;
+	gScheduler.SetTargetRate(gOptions.frameRate);
+	if (gOptions.traceFile)
+	{
+		gTraceFile = gOptions.traceFile;
+		gTraceFormat = gOptions.traceBinary ? TRACE_BINARY : TRACE_JSON;
+	}
+
+	if (!gOptions.headless)
+		InitWindow(argc, argv);
+	atexit(ExitCallback);
+
+	// Initialise the PhysX SDK.
+	if (!InitPhysX())
+	{
+		printf("Could not initialise PhysX.\n");
+		ExitCallback();
+	}
+
+	// Initialise the simulation scene.
+	InitScene();
+	if (gOptions.sceneFile && !LoadSimulationState(gOptions.sceneFile))
+		printf("Could not load %s, it must be saved from a scene with the same actors.\n", gOptions.sceneFile);
+
+	if (gOptions.traceFile)
+		ToggleTrace();
+
+	if (gOptions.headless) return;
+
+	MotionCallback(0,0);
+
+	PrintControls();
+
+	InitHUD();
+}
+
+///
+/// Assign callback functions and set-up lighting.
+///
+void InitWindow(int argc, char** argv)
 {
 	glutInit(&argc, argv);
-	glutInitWindowSize(512, 512);
+	glutInitWindowSize(gOptions.windowWidth, gOptions.windowHeight);
 	glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
 
 	//callbacks
@@ -54,7 +200,9 @@ void Init(int argc, char** argv)
 	glutSpecialFunc(KeySpecial);
 	glutMouseFunc(MouseCallback);
 	glutMotionFunc(MotionCallback);
-	atexit(ExitCallback);
+
+	//held keys
+	InitInput();
 
 	//default render states
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -82,30 +230,193 @@ void Init(int argc, char** argv)
 	glLightfv(GL_LIGHT1, GL_DIFFUSE, DiffuseColor);
 	glLightfv(GL_LIGHT1, GL_SPECULAR, SpecularColor);
 	glLightfv(GL_LIGHT1, GL_POSITION, Position);
+}
 
-	// Initialise the PhysX SDK.
-	if (!InitPhysX())
+///
+/// Start the simulation thread and enter the GLUT's main loop.
+///
+void StartMainLoop() 
+{
+	if (gOptions.headless)
 	{
-		printf("Could not initialise PhysX.\n");
-		ExitCallback();
+		RunHeadless();
+		return;
 	}
 
-	// Initialise the simulation scene.
-	InitScene();
-	
-	MotionCallback(0,0);
+	gTrace.SetThreadName("render");
+	gBenchmarkStart = getPreciseTime();
+	StartSimulation();
+	glutMainLoop(); 
+}
 
-	PrintControls();
+///
+/// Step the scene back to back on the calling thread, nothing is drawn or paced.
+///
+void RunHeadless()
+{
+	printf("Running headless for %.1f s\n", gOptions.benchmarkTime);
+	gTrace.SetThreadName("simulation");
+	double start = getPreciseTime();
+	while (getPreciseTime() - start < gOptions.benchmarkTime)
+		SimulationThreadStep(0, gOptions.timeStep);
 
-	InitHUD();
+	//wait for the step started last
+	if (bStepRunning)
+	{
+		GetPhysicsResults();
+		bStepRunning = false;
+	}
+
+	PrintBenchmark(getPreciseTime() - start);
+	exit(0);
 }
 
 ///
-/// Start the first step of simulation and enter the GLUT's main loop.
+/// Print the number of steps and frames of a timed run, the simulation must be stopped.
 ///
-void StartMainLoop() 
+void PrintBenchmark(double seconds)
 {
-	glutMainLoop(); 
+	printf("\nBenchmark: %u actors, %u steps of %.4f s in %.2f s, %.1f steps/s, %.3f ms per step\n",
+		scene->getNbActors(), gStepIndex, gOptions.timeStep, seconds, gStepIndex/seconds, gStepIndex ? seconds*1000.0/gStepIndex : 0.0);
+	if (!gOptions.headless)
+		printf("  %u frames drawn, %.1f fps, %u steps skipped to keep up\n",
+			gScheduler.GetNbFrames(), gScheduler.GetNbFrames()/seconds, gSimulationThread.GetNbSkipped());
+}
+
+///
+/// Start stepping the scene on the simulation thread.
+///
+void StartSimulation()
+{
+	bCapturePoses = true;
+	gSimulationThread.SetThreadFunctions(SimulationThreadStart, SimulationThreadExit);
+	if (!gSimulationThread.Start(SimulationThreadStep, 0, gOptions.timeStep))
+		printf("Could not start the simulation thread.\n");
+}
+
+///
+/// Stop the simulation thread, the scene can be used by the calling thread afterwards.
+///
+void StopSimulation()
+{
+	if (!gSimulationThread.IsRunning()) return;
+
+	gSimulationThread.Stop();
+	//wait for the step started last
+	GetPhysicsResults();
+	bStepRunning = false;
+}
+
+///
+/// Name the simulation thread in the trace once.
+///
+void SimulationThreadStart(void* context)
+{
+	gTrace.SetThreadName("simulation");
+}
+
+///
+/// Hand the trace ring of the ending simulation thread to the next one.
+///
+void SimulationThreadExit(void* context)
+{
+	gTrace.ReleaseThread();
+}
+
+///
+/// Perform one fixed step on the simulation thread: handle the requests of the GLUT thread,
+/// hand the poses to the renderer and start the next step.
+///
+void SimulationThreadStep(void* context, NxReal timeStep)
+{
+	TraceScope trace(gTrace, "step");
+
+	//the actors that were awake during the last step have moved
+	bool moved = bStepRunning && gSleepNotify.GetNbAwake() > 0;
+
+	//get new results
+	if (bStepRunning)
+	{
+		PhaseTimer timer(PERF_FETCH);
+		GetPhysicsResults();
+		bStepRunning = false;
+	}
+
+	//take the requests over, the GLUT thread holds the lock only to post them
+	bool saveState, loadState, pick, toggleRecording, paused, capture;
+	NxRay pickRay;
+	{
+		ScopedLock lock(gRequestLock);
+		saveState = bSaveState;
+		loadState = bLoadState;
+		pick = bPick;
+		pickRay = gPickRay;
+		toggleRecording = bToggleRecording;
+		paused = bPause;
+		capture = bCapturePoses;
+		bSaveState = bLoadState = bPick = bToggleRecording = bCapturePoses = false;
+	}
+
+	if (saveState)
+	{
+		if (SaveSimulationState(gStateFile))
+			printf("State saved to %s\n", gStateFile);
+		else
+			printf("Could not save state to %s\n", gStateFile);
+	}
+	if (loadState)
+	{
+		if (LoadSimulationState(gStateFile))
+			printf("State loaded from %s\n", gStateFile);
+		else
+			printf("Could not load state from %s\n", gStateFile);
+	}
+	if (pick)
+	{
+		ActorHandle picked = PickActor(pickRay);
+		ScopedLock lock(gRequestLock);
+		gSelectedActor = picked;
+	}
+	if (toggleRecording)
+		ToggleRecording();
+
+	if (!paused)
+	{
+		//copy the new poses, encoding and writing happen on the recorder's thread
+		if (gRecorder.IsRecording())
+			gRecorder.RecordFrame(*scene);
+
+		//user defined process function, it consumes the contacts
+		gPerfHUD.SetCount(PERF_CONTACTS, gContactReport.GetNbEvents());
+		PhaseTimer timer(PERF_UPDATE);
+		UpdateScene();
+	}
+	gPerfHUD.SetCount(PERF_ACTORS, scene->getNbActors());
+	gPerfHUD.SetCount(PERF_AWAKE, gSleepNotify.GetNbAwake());
+
+	//the renderer draws from this copy while the next step runs, nothing new lets it skip the redraw
+	if (!gOptions.headless && (moved || capture || loadState || pick))
+	{
+		PhaseTimer timer(PERF_CAPTURE);
+		gPoses.Capture(*scene, gStepIndex, rendering_mode != RENDER_SOLID);
+	}
+
+	if (paused) return;
+
+	//handle the held force keys
+	{
+		PhaseTimer timer(PERF_FORCES);
+		ScopedLock lock(gRequestLock);
+		ApplyHeldForces();
+	}
+
+	//start new simulation step
+	{
+		PhaseTimer timer(PERF_SIMULATE);
+		SimulationStep(timeStep);
+	}
+	bStepRunning = true;
+	gStepIndex++;
 }
 
 ///
@@ -123,102 +434,243 @@ void InitHUD()
 
 	//pause message
 	hud.AddDisplayString("", 0.3f, 0.55f);
+
+	//replay message
+	hud.AddDisplayString("", 0.02f, 0.92f);
+
+	//performance overlay, empty until shown with 'h'
+	gPerfHUD.Init(hud, 0.02f, 0.86f);
 }
 
 void Display()
 {
-	//clear display buffers
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	{
+		PhaseTimer timer(PERF_DRAW);
 
-	//set the camera view
-	SetupCamera();
+		//clear display buffers
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	//display scene
-	if (rendering_mode != RENDER_WIREFRAME)
-		RenderActors(bShadows);
-	if (debugRenderable)
-		gDebugRenderer.renderData(*debugRenderable);
+		//set the camera view
+		SetupCamera();
 
-	//render HUD
-	hud.Render();
+		//display scene, from the latest simulation step
+		const PoseFrame* frame = bReplay ? 0 : gPoses.AcquireLatest();
+		if (rendering_mode != RENDER_WIREFRAME)
+		{
+			if (bReplay)
+				RenderReplayActors(bShadows);
+			else if (frame)
+				RenderActors(*frame, bShadows);
+		}
+		if (frame && rendering_mode != RENDER_SOLID && frame->HasDebugData())
+			gDebugRenderer.renderData(frame->GetDebugRenderable());
 
+		//render HUD
+		gPerfHUD.RenderGraph();
+		gPerfHUD.Update(hud);
+		hud.Render();
+	}
+
+	PhaseTimer timer(PERF_SWAP);
 	glFlush();
 	glutSwapBuffers();
 }
 
 ///
-/// Perform one step of simulation, process input keys and render the scene.
+/// Process input keys and render the scene, the simulation runs on its own thread.
 ///
 void RenderCallback()
 {
-	if (scene && !bPause)
-	{
-		//get new results
-		GetPhysicsResults();
+	TraceScope trace(gTrace, "frame");
 
-		debugRenderable = 0;
-		if (rendering_mode != RENDER_SOLID)
-			debugRenderable = scene->getDebugRenderable();
+	//the camera moves at the rendering frame rate, the actors at the simulation rate
+	gFrameTime = gScheduler.GetTickTime();
 
-		//user defined process function
-		UpdateScene();
+	//time between drawn frames, not counting the pauses while nothing changed
+	double frameStart = getPreciseTime();
+	if (gScheduler.GetNbSkipped() == gLastSkipped)
+		gPerfHUD.AddFrame((NxReal)(frameStart - gLastFrameStart));
+	gLastFrameStart = frameStart;
+	gLastSkipped = gScheduler.GetNbSkipped();
 
-		//handle keyboard
-		KeyHold();
+	if (bReplay)
+	{
+		TraceScope replay(gTrace, "replay");
+		UpdateReplay();
+	}
 
-		//start new simulation step
-		SimulationStep();
+	//handle keyboard
+	{
+		PhaseTimer timer(PERF_KEYS);
+		KeyHold();
 	}
 
 	Display();
 }
 
 ///
-/// Draw a force arrow.
+/// Start or stop replaying the trajectory file instead of simulating.
 ///
-void DrawForce(NxActor* actor, NxVec3& forceVec, const NxVec3& color)
+void ToggleReplay()
 {
-	if (actor)
+	if (bReplay)
 	{
-		// Draw only if the force is large enough
-		NxReal force = forceVec.magnitude();
-		if (force < 0.1)  return;
+		gPlayer.Close();
+		bReplay = false;
+		hud.SetDisplayString(2, "", 0.02f, 0.92f);
+		//resume the simulation from where it was left
+		StartSimulation();
+		return;
+	}
+
+	//the scene is drawn directly during the replay, no steps run until it ends
+	StopSimulation();
 
-		forceVec = 2*forceVec/force;
+	//the file can't be replayed while it's being written
+	if (gRecorder.IsRecording())
+		gRecorder.Stop();
 
-		NxVec3 pos = actor->getCMassGlobalPosition();
-		DrawArrow(pos, pos + forceVec, color);
+	if (!gPlayer.Open(gTrajectoryFile))
+	{
+		printf("Could not replay %s\n", gTrajectoryFile);
+		StartSimulation();
+		return;
 	}
+
+	bReplay = true;
+	gReplayFrame = 0;
+	gReplaySpeed = 1;
+	gSelectedActor = ActorHandle();
+	gForceVec = NxVec3(0,0,0);
+	printf("Replaying %u frames from %s\n", gPlayer.GetNbFrames(), gTrajectoryFile);
+}
+
+///
+/// Advance the replay by one frame at the replay speed.
+///
+void UpdateReplay()
+{
+	NxReal lastFrame = (NxReal)(gPlayer.GetNbFrames() - 1);
+	if (!bPause)
+		gReplayFrame += gReplaySpeed;
+	if (gReplayFrame > lastFrame) gReplayFrame = lastFrame;
+	if (gReplayFrame < 0) gReplayFrame = 0;
+	gPlayer.Seek((NxU32)gReplayFrame);
+
+	char text[128];
+	sprintf(text, "Replay %u/%u x%.2f", gPlayer.GetCurrentFrame() + 1, gPlayer.GetNbFrames(), gReplaySpeed);
+	hud.SetDisplayString(2, text, 0.02f, 0.92f);
 }
 
 ///
-/// Render all actors in default colour. Render the selected actor in alternative colour.
+/// Start or stop tracing the step and frame phases to the trace file.
 ///
-void RenderActors(bool shadows)
+void ToggleTrace()
 {
+	if (gTrace.IsRecording())
+	{
+		gTrace.Stop();
+		printf("%u trace events written to %s, %u dropped\n", gTrace.GetNbWritten(), gTraceFile, gTrace.GetNbDropped());
+		return;
+	}
+
+	if (gTrace.Start(gTraceFile, gTraceFormat))
+		printf("Tracing to %s\n", gTraceFile);
+	else
+		printf("Could not open %s, no trace will be written.\n", gTraceFile);
+}
+
+///
+/// Draw a force arrow at the centre of mass of an actor.
+///
+void DrawForce(const NxVec3& centerOfMass, NxVec3& forceVec, const NxVec3& color)
+{
+	// Draw only if the force is large enough
+	NxReal force = forceVec.magnitude();
+	if (force < 0.1)  return;
+
+	forceVec = 2*forceVec/force;
+
+	DrawArrow(centerOfMass, centerOfMass + forceVec, color);
+}
+
+///
+/// Render all actors in default colour from the copy of a simulation step. Render the selected actor in alternative colour.
+/// Only the frame is read, the actors and shapes belong to the simulation thread.
+///
+void RenderActors(const PoseFrame& frame, bool shadows)
+{
+	ActorHandle selected;
+	NxVec3 forceVec;
+	{
+		ScopedLock lock(gRequestLock);
+		selected = gSelectedActor;
+		forceVec = gForceVec;
+	}
+
 	//iterate through all actors
+	for (NxU32 i = 0; i < frame.poses.size(); i++)
+	{
+		const ActorPose& actor = frame.poses[i];
+		const ShapePose* shapes = actor.nbShapes ? &frame.shapes[actor.firstShape] : 0;
+
+		//draw the selected actor using GL_LIGHT1
+		bool isSelected = selected.IsValid() && actor.handle == selected;
+		bool useLight1 = isSelected || (actor.flags & UD_RENDER_USING_LIGHT1);
+		if (useLight1)
+		{
+			glDisable(GL_LIGHT0);
+			glEnable(GL_LIGHT1);
+		}
+		for (NxU32 j = 0; j < actor.nbShapes; j++)
+			DrawShape(shapes[j].type, shapes[j].pose, shapes[j].dimensions, shapes[j].meshData);
+		if (useLight1)
+		{
+			glDisable(GL_LIGHT1);
+			glEnable(GL_LIGHT0);
+		}
+
+		//draw force arrow
+		if (isSelected)
+			DrawForce(actor.centerOfMass, forceVec, NxVec3(1,1,0));
+
+		//draw shadows
+		if (shadows)
+		{
+			for (NxU32 j = 0; j < actor.nbShapes; j++)
+				DrawShapeShadow(shapes[j].type, shapes[j].pose, shapes[j].dimensions, shapes[j].meshData);
+		}
+	}
+}
+
+///
+/// Render the dynamic actors at the poses of the current replay frame.
+///
+void RenderReplayActors(bool shadows)
+{
+	const TrajectoryPose* poses = gPlayer.GetPoses();
+	NxU32 nbPoses = gPlayer.GetNbActors();
 	NxU32 nbActors = scene->getNbActors();
 	NxActor** actors = scene->getActors();
-	while (nbActors--)
+	for (NxU32 i = 0; i < nbActors; i++)
 	{
-		NxActor* actor = *actors++;
+		NxActor* actor = actors[i];
 
-		if (actor == gSelectedActor) //draw the selected actor using GL_LIGHT1
+		//static actors and actors created after the recording are drawn where they are
+		if (!actor->isDynamic() || i >= nbPoses)
 		{
-			ActorUserData ud;
-			ud.flags |= UD_RENDER_USING_LIGHT1;
-			actor->userData = &ud;
 			DrawActor(actor, 0, false);
-			actor->userData = 0;
-			//draw force arrow
-			DrawForce(gSelectedActor, gForceVec, NxVec3(1,1,0));
+			if (shadows)
+				DrawActorShadow(actor, false);
+			continue;
 		}
-		else
-			DrawActor(actor, 0, false); //draw all actors using GL_LIGHT0
 
-		//draw shadows
+		NxMat34 pose;
+		pose.M.fromQuat(poses[i].orientation);
+		pose.t = poses[i].position;
+		DrawActor(actor, pose, false);
 		if (shadows)
-			DrawActorShadow(actor, false);
+			DrawActorShadow(actor, pose, false);
 	}
 }
 
@@ -227,50 +679,85 @@ void RenderActors(bool shadows)
 ///
 bool IsSelectable(NxActor* actor)
 {
-   NxShape*const* shapes = gSelectedActor->getShapes();
-   NxU32 nShapes = gSelectedActor->getNbShapes();
-   while (nShapes--)
-       if (shapes[nShapes]->getFlag(NX_TRIGGER_ENABLE)) 
-           return false;
+	return ActorHandleTable::IsSelectable(*actor);
+}
+
+///
+/// Select the next selectable actor on the scene, none if there is no selectable actor.
+///
+void SelectNextActor()
+{
+	gSelectedActor = gActorHandles.GetNextSelectable(gSelectedActor);
+}
+
+///
+/// Make a ray from the camera through the window coordinates x, y.
+///
+NxRay GetPickRay(int x, int y)
+{
+	int width = glutGet(GLUT_WINDOW_WIDTH);
+	int height = glutGet(GLUT_WINDOW_HEIGHT);
+	if (width <= 0) width = 1;
+	if (height <= 0) height = 1;
 
-   if(!actor->isDynamic())
-	   return false;
+	//unproject through the view set up in SetupCamera: 60 degrees vertical field of view
+	NxReal tanHalfFov = NxMath::tan(NxMath::degToRad(30.0f));
+	NxReal ndcX = 2.0f*(x + 0.5f)/width - 1.0f;
+	NxReal ndcY = 1.0f - 2.0f*(y + 0.5f)/height;
 
-   return true;
+	NxVec3 forward = gCameraForward;
+	forward.normalize();
+	NxVec3 right;
+	right.cross(forward, NxVec3(0,1,0));
+	right.normalize();
+	NxVec3 up;
+	up.cross(right, forward);
+
+	NxRay ray;
+	ray.orig = gCameraPos;
+	ray.dir = forward + right*(ndcX*tanHalfFov*width/height) + up*(ndcY*tanHalfFov);
+	ray.dir.normalize();
+	return ray;
 }
 
 ///
-/// Select the next actor on the scene.
-//
-void SelectNextActor()
+/// Keeps the closest hit of a raycast that isn't a trigger shape.
+///
+class PickReport : public NxUserRaycastReport
+{
+public:
+	PickReport() : shape(0), distance(NX_MAX_F32) {}
+
+	virtual bool onHit(const NxRaycastHit& hit)
+	{
+		//the hits don't come sorted, look at all of them
+		ShapeUserData* sud = (ShapeUserData*)hit.shape->userData;
+		bool trigger = sud ? (sud->flags & UD_IS_TRIGGER) != 0 : hit.shape->getFlag(NX_TRIGGER_ENABLE);
+		if (!trigger && hit.distance < distance)
+		{
+			shape = hit.shape;
+			distance = hit.distance;
+		}
+		return true;
+	}
+
+	NxShape* shape;
+	NxReal distance;
+};
+
+///
+/// Find the closest selectable actor hit by a ray, call between steps.
+///
+ActorHandle PickActor(const NxRay& pickRay)
 {
-   NxU32 nbActors = scene->getNbActors();
-   NxActor** actors = scene->getActors();
-   for(NxU32 i = 0; i < nbActors; i++)
-   {
-       if (actors[i] == gSelectedActor)
-       {
-           NxU32 j = 1;
-           gSelectedActor = actors[(i+j)%nbActors];
-           while (!IsSelectable(gSelectedActor))
-           {
-               j++;
-               gSelectedActor = actors[(i+j)%nbActors];
-           }
-           break;
-       }
-   }
-
-   if (!gSelectedActor)
-   {
-	   for(NxU32 i = 0; i < nbActors; i++)
-	   {
-		   gSelectedActor = actors[i];
-		   if (IsSelectable(gSelectedActor))
-			   return;
-	   }
-	   gSelectedActor = 0; // none found
-   }
+	//one broadphase query, trigger shapes are looked through by the report
+	PickReport report;
+	scene->raycastAllShapes(pickRay, report, NX_DYNAMIC_SHAPES, 0xffffffff, NX_MAX_F32, NX_RAYCAST_SHAPE | NX_RAYCAST_DISTANCE);
+
+	NxShape* shape = report.shape;
+	if (shape && IsSelectable(&shape->getActor()))
+		return gActorHandles.GetHandle(shape->getActor());
+	return ActorHandle();
 }
 
 /// 
@@ -321,6 +808,7 @@ void ReshapeCallback(int width, int height)
 {
 	glViewport(0, 0, width, height);
 	gCameraAspectRatio = float(width)/float(height);
+	gScheduler.Invalidate();
 }
 
 ///
@@ -328,6 +816,8 @@ void ReshapeCallback(int width, int height)
 ///
 void KeyPress(unsigned char key, int x, int y)
 {
+	gScheduler.Invalidate();
+
 	if (!gKeys[key]) // ensure the keypress is only executed once
 	{
 		switch (key)
@@ -339,21 +829,69 @@ void KeyPress(unsigned char key, int x, int y)
 				rendering_mode = RENDER_BOTH;
 			else if (rendering_mode == RENDER_BOTH)
 				rendering_mode = RENDER_SOLID;
+			{
+				//the debug data is only copied while it's shown
+				ScopedLock lock(gRequestLock);
+				bCapturePoses = true;
+			}
 			break;
 		case 'p':
-			bPause = !bPause; 
+			{
+				ScopedLock lock(gRequestLock);
+				bPause = !bPause;
+			}
 			if (bPause)
 				hud.SetDisplayString(1, "Paused - Hit \"p\" to Unpause", 0.3f, 0.55f);
 			else
 				hud.SetDisplayString(1, "", 0.3f, 0.55f);	
-			getElapsedTime(); 
 			break; 
 		case 'r':
-			SelectNextActor();
+			{
+				ScopedLock lock(gRequestLock);
+				SelectNextActor();
+			}
+			break;
+		case 'f': //the selected actor follows the force keys after it's deselected
+			{
+				ScopedLock lock(gRequestLock);
+				if (gInput.IsActorBound(gSelectedActor))
+					gInput.UnbindActor(gSelectedActor);
+				else
+					gInput.BindActor(gSelectedActor, FORCE_ACTIONS);
+			}
+			break;
+		case 'h': //performance overlay
+			gPerfHUD.SetVisible(hud, !gPerfHUD.IsVisible());
+			break;
+		case 't': //start/stop tracing, the trace is written while it runs
+			ToggleTrace();
 			break;
 		case 'x': 
 			bShadows = !bShadows; 
 			break;
+		case 'c': //start/stop recording trajectories
+			if (!bReplay)
+			{
+				ScopedLock lock(gRequestLock);
+				bToggleRecording = true;
+			}
+			break;
+		case 'v': //start/stop replaying trajectories
+			ToggleReplay();
+			break;
+		case '[': //replay seek back/forward
+			gReplayFrame -= gReplaySeekFrames;
+			break;
+		case ']':
+			gReplayFrame += gReplaySeekFrames;
+			break;
+		case '-': //replay speed
+			if (gReplaySpeed > 0.125f) gReplaySpeed *= 0.5f;
+			break;
+		case '+':
+		case '=':
+			if (gReplaySpeed < 16.0f) gReplaySpeed *= 2.0f;
+			break;
 		case 27: //ESC
 			exit(0);
 			break;
@@ -363,6 +901,47 @@ void KeyPress(unsigned char key, int x, int y)
 	}
 
 	gKeys[key] = true;
+	ScopedLock lock(gRequestLock);
+	gInput.KeyDown(key);
+}
+
+///
+/// Start or stop recording the trajectories, call between steps.
+///
+void ToggleRecording()
+{
+	if (gRecorder.IsRecording())
+	{
+		gRecorder.Stop();
+		printf("Recorded %u frames to %s (%u bytes, %u stalls)\n", gRecorder.GetNbFrames(), gTrajectoryFile,
+			gRecorder.GetBytesWritten(), gRecorder.GetNbStalls());
+	}
+	else if (gRecorder.Start(gTrajectoryFile))
+		printf("Recording to %s\n", gTrajectoryFile);
+	else
+		printf("Could not record to %s\n", gTrajectoryFile);
+}
+
+///
+/// Bind the camera and force keys to their actions.
+///
+void InitInput()
+{
+	//camera controls
+	gInput.Bind('w', ACTION_CAMERA_FORWARD, NxVec3(0,0,1));
+	gInput.Bind('s', ACTION_CAMERA_BACK, NxVec3(0,0,-1));
+	gInput.Bind('a', ACTION_CAMERA_LEFT, NxVec3(-1,0,0));
+	gInput.Bind('d', ACTION_CAMERA_RIGHT, NxVec3(1,0,0));
+	gInput.Bind('z', ACTION_CAMERA_DOWN, NxVec3(0,-1,0));
+	gInput.Bind('q', ACTION_CAMERA_UP, NxVec3(0,1,0));
+
+	//force controls
+	gInput.Bind('i', ACTION_FORCE_POS_Z, NxVec3(0,0,1));
+	gInput.Bind('k', ACTION_FORCE_NEG_Z, NxVec3(0,0,-1));
+	gInput.Bind('j', ACTION_FORCE_POS_X, NxVec3(1,0,0));
+	gInput.Bind('l', ACTION_FORCE_NEG_X, NxVec3(-1,0,0));
+	gInput.Bind('u', ACTION_FORCE_POS_Y, NxVec3(0,1,0));
+	gInput.Bind('m', ACTION_FORCE_NEG_Y, NxVec3(0,-1,0));
 }
 
 ///
@@ -370,53 +949,25 @@ void KeyPress(unsigned char key, int x, int y)
 ///
 void KeyHold()
 {
-	// Process camera keys
-	for (int i = 0; i < MAX_KEYS; i++)
-	{	
-		if (!gKeys[i])  { continue; }
+	// Camera controls, the forces are applied by the simulation thread
+	if (!(gInput.GetActive() & CAMERA_ACTIONS)) return;
 
-		switch (i)
-		{
-			// Camera controls
-		case 'w':
-			gCameraPos += gCameraForward*gCameraSpeed*delta_time;
-			break;
-		case 's':
-			gCameraPos -= gCameraForward*gCameraSpeed*delta_time;
-			break;
-		case 'a':
-			gCameraPos -= gCameraRight*gCameraSpeed*delta_time;
-			break;
-		case 'd':
-			gCameraPos += gCameraRight*gCameraSpeed*delta_time;
-			break;
-		case 'z':
-			gCameraPos -= NxVec3(0,1,0)*gCameraSpeed*delta_time;
-			break;
-		case 'q':
-			gCameraPos += NxVec3(0,1,0)*gCameraSpeed*delta_time;
-			break;
-		// Force controls
-		case 'i':
-			gForceVec = ApplyForceToActor(gSelectedActor,NxVec3(0,0,1),gForceStrength);
-			break;
-		case 'k':
-			gForceVec = ApplyForceToActor(gSelectedActor,NxVec3(0,0,-1),gForceStrength);
-			break;
-		case 'j':
-			gForceVec = ApplyForceToActor(gSelectedActor,NxVec3(1,0,0),gForceStrength);
-			break;
-		case 'l':
-			gForceVec = ApplyForceToActor(gSelectedActor,NxVec3(-1,0,0),gForceStrength);
-			break;
-		case 'u':
-			gForceVec = ApplyForceToActor(gSelectedActor,NxVec3(0,1,0),gForceStrength);
-			break;
-		case 'm':
-			gForceVec = ApplyForceToActor(gSelectedActor,NxVec3(0,-1,0),gForceStrength);
-			break;
-		}
-	}
+	NxVec3 move = gInput.GetAxis(CAMERA_ACTIONS);
+	gCameraPos += (gCameraRight*move.x + NxVec3(0,1,0)*move.y + gCameraForward*move.z)*gCameraSpeed*gFrameTime;
+}
+
+///
+/// Push the selected actor and the actors bound with 'f' while force keys are held.
+/// Called by the simulation thread with gRequestLock held.
+///
+void ApplyHeldForces()
+{
+	if (!(gInput.GetActive() & FORCE_ACTIONS)) return;
+
+	//a selected actor that is also bound is pushed by its binding only, the arrow is still drawn
+	NxActor* selected = gInput.IsActorBound(gSelectedActor) ? 0 : gActorHandles.Get(gSelectedActor);
+	gForceVec = ApplyForceToActor(selected, gInput.GetAxis(FORCE_ACTIONS), gForceStrength);
+	gInput.ApplyForces(gActorHandles, gForceStrength*delta_time);
 }
 
 ///
@@ -424,17 +975,14 @@ void KeyHold()
 ///
 void KeyRelease(unsigned char key, int x, int y)
 {
+	gScheduler.Invalidate();
 	gKeys[key] = false;
+	ScopedLock lock(gRequestLock);
+	gInput.KeyUp(key);
 
-	switch (key)
-	{
 	//force controls
-	case 'i': case 'k': case 'j': case 'l': case 'u': case 'm':
+	if (!(gInput.GetActive() & FORCE_ACTIONS))
 		gForceVec = NxVec3(0,0,0);
-		break;
-	default:
-		break;
-	}
 }
 
 ///
@@ -442,12 +990,34 @@ void KeyRelease(unsigned char key, int x, int y)
 ///
 void KeySpecial(int key, int x, int y)
 {
+	gScheduler.Invalidate();
+
 	switch (key)
 	{
+	case GLUT_KEY_F5: // Save the state of all actors
+		{
+			ScopedLock lock(gRequestLock);
+			bSaveState = true;
+		}
+		break;
+	case GLUT_KEY_F9: // Restore the saved state
+		{
+			ScopedLock lock(gRequestLock);
+			bLoadState = true;
+		}
+		break;
 	case GLUT_KEY_F10: // Reset PhysX and View
-		ResetPhysX();
-		ResetCamera();
-		gSelectedActor = 0;
+		{
+			//the poses refer to the released actors
+			bool running = gSimulationThread.IsRunning();
+			StopSimulation();
+			ResetPhysX();
+			gPoses.Clear();
+			ResetCamera();
+			gSelectedActor = ActorHandle();
+			if (running)
+				StartSimulation();
+		}
 		break; 
 	default:
 		break;
@@ -465,6 +1035,16 @@ void MouseCallback(int button, int state, int x, int y)
 {
 	mx = x;
 	my = y;
+	gScheduler.Invalidate();
+
+	//the ray is cast by the simulation thread between steps
+	if (button == GLUT_RIGHT_BUTTON && state == GLUT_DOWN && !bReplay)
+	{
+		NxRay ray = GetPickRay(x, y);
+		ScopedLock lock(gRequestLock);
+		bPick = true;
+		gPickRay = ray;
+	}
 }
 
 ///
@@ -474,6 +1054,7 @@ void MotionCallback(int x, int y)
 {
 	int dx = mx - x;
 	int dy = my - y;
+	gScheduler.Invalidate();
 
 	gCameraForward.normalize();
 	gCameraRight.cross(gCameraForward,NxVec3(0,1,0));
@@ -487,12 +1068,42 @@ void MotionCallback(int x, int y)
 	my = y;
 }
 
-void IdleCallback() { glutPostRedisplay(); }
+///
+/// Redraw at the target frame rate if anything changed, sleep otherwise.
+///
+void IdleCallback()
+{
+	//a timed run ends by itself
+	if (gOptions.benchmarkTime > 0 && getPreciseTime() - gBenchmarkStart >= gOptions.benchmarkTime)
+	{
+		StopSimulation();
+		PrintBenchmark(getPreciseTime() - gBenchmarkStart);
+		exit(0);
+	}
+
+	//a new simulation step, a replay frame or a moving camera
+	NxU32 nbPublished = gPoses.GetNbPublished();
+	if (nbPublished != gLastPublished || (bReplay && !bPause) || (gInput.GetActive() & CAMERA_ACTIONS))
+		gScheduler.Invalidate();
+	gLastPublished = nbPublished;
+
+	if (gScheduler.WaitForFrame())
+		glutPostRedisplay();
+}
 
 ///
-/// Release PhysX SDK on exit.
+/// Stop recording, release PhysX SDK and report the memory usage on exit.
 ///
-void ExitCallback() { ReleasePhysX(); }
+void ExitCallback()
+{
+	StopSimulation();
+	if (gTrace.IsRecording()) ToggleTrace();
+	gRecorder.Stop();
+	gPlayer.Close();
+	PrintUserDataStats();
+	ReleasePhysX();
+	gAllocator.PrintStats();
+}
 
 ///
 /// Simple info printed out in the command line.
@@ -501,5 +1112,5 @@ void PrintControls()
 {
 	printf("\n Flight Controls:\n ----------------\n w = forward, s = back\n a = strafe left, d = strafe right\n q = up, z = down\n");
     printf("\n Force Controls:\n ---------------\n i = +z, k = -z\n j = +x, l = -x\n u = +y, m = -y\n");
-	printf("\n Miscellaneous:\n --------------\n p   = Pause\n x   = Toggle Shadows\n r   = Select Actor\n  b   = Toggle Visualisation Mode\n F10 = Reset scene\n ESC = Exit\n");
+	printf("\n Miscellaneous:\n --------------\n p   = Pause\n x   = Toggle Shadows\n h   = Toggle Performance HUD\n t   = Start/Stop Trace\n r   = Select Actor\n f   = Bind/Unbind Actor to Force Keys\n right click = Pick Actor\n c   = Start/Stop Recording\n v   = Start/Stop Replay\n [ ] = Replay Seek\n - + = Replay Speed\n  b   = Toggle Visualisation Mode\n F5  = Save state\n F9  = Load state\n F10 = Reset scene\n ESC = Exit\n");
 }
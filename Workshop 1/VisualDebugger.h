@@ -7,7 +7,11 @@
 
 #pragma once
 
+#include "NxPhysics.h"
 #include "Extras\DebugRenderer.h"
+#include "Extras\ActorHandles.h"
+
+struct PoseFrame;
 
 ///
 ///Rendering mode.
@@ -22,20 +26,54 @@ enum RenderingMode
 	RENDER_BOTH			
 };
 
-///Initialise the framework.
+///Initialise the framework, the options are described by PrintUsage.
 void Init(int argc, char** argv);
 
+///Create the window, assign the callbacks and set the render states.
+void InitWindow(int argc, char** argv);
+
 ///Start the main loop.
 void StartMainLoop();
 
+///Step the scene without a window for the benchmark time, then exit.
+void RunHeadless();
+
+///Report the step and frame rates of a timed run.
+void PrintBenchmark(double seconds);
+
+///Start the simulation thread.
+void StartSimulation();
+
+///Stop the simulation thread and wait for the running step.
+void StopSimulation();
+
+///Simulation thread callback.
+void SimulationThreadStep(void* context, NxReal timeStep);
+
+///Simulation thread start and exit callbacks.
+void SimulationThreadStart(void* context);
+void SimulationThreadExit(void* context);
+
 ///Initialise HUD.
 void InitHUD();
 
 ///Rendering callback.
 void RenderCallback();
 
-///Render all actors on the scene.
-void RenderActors(bool shadows);
+///Start/stop replaying the recorded trajectory.
+void ToggleReplay();
+
+///Advance the replay.
+void UpdateReplay();
+
+///Start/stop writing the trace of the step and frame phases.
+void ToggleTrace();
+
+///Render all actors from the copy of a simulation step, without reading the scene.
+void RenderActors(const PoseFrame& frame, bool shadows);
+
+///Render all actors at the poses of the current replay frame.
+void RenderReplayActors(bool shadows);
 
 ///Setup the camera view.
 void SetupCamera();
@@ -43,6 +81,15 @@ void SetupCamera();
 ///Reset the camera view.
 void ResetCamera();
 
+///Ray through the window coordinates, from the camera.
+NxRay GetPickRay(int x, int y);
+
+///Closest selectable actor hit by the ray.
+ActorHandle PickActor(const NxRay& ray);
+
+///Start/stop recording trajectories.
+void ToggleRecording();
+
 ///Resize window callback.
 void ReshapeCallback(int width, int height);
 
@@ -55,6 +102,12 @@ void KeyRelease(unsigned char key, int x, int y);
 ///Handle key holds.
 void KeyHold();
 
+///Apply the forces of the held keys.
+void ApplyHeldForces();
+
+///Bind the keys handled in KeyHold to their actions.
+void InitInput();
+
 ///Handle special key presses.
 void KeySpecial(int key, int x, int y);
 